@@ -0,0 +1,97 @@
+#include "order_book.h"
+#include "bench_util.h"
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <random>
+
+// Call auction benchmark: accumulates orders in the call phase, both sides
+// normally distributed around 100.00 on a 0.01 grid with the bids centred
+// a little higher, so most of the book crosses. Reports
+//   - the cost per accumulated add
+//   - indicative_uncross() (the clearing price alone), best of several calls
+//   - uncross(): price search plus executing and reporting every fill
+//
+//   order_book_auction_bench [num_orders] [spread_ticks]
+
+struct TradeCount {
+    uint64_t trades = 0;
+    uint64_t quantity = 0;
+
+    static void on_trade(const Trade& trade, void* context) {
+        TradeCount* count = static_cast<TradeCount*>(context);
+        count->trades++;
+        count->quantity += trade.quantity;
+    }
+};
+
+static std::vector<Order> make_orders(size_t num_orders, double spread_ticks) {
+    std::mt19937_64 gen(2027);
+    std::normal_distribution<double> ticks(0.0, spread_ticks);
+    std::uniform_int_distribution<uint64_t> quantity(1, 100);
+    std::vector<Order> orders;
+    orders.reserve(num_orders);
+    for (size_t i = 0; i < num_orders; ++i) {
+        bool is_buy = (i & 1) == 0;
+        double offset = std::round(ticks(gen) + (is_buy ? 5.0 : -5.0));
+        orders.emplace_back(i + 1, is_buy, 100.0 + offset * 0.01, quantity(gen), i);
+    }
+    return orders;
+}
+
+int main(int argc, char** argv) {
+    size_t num_orders = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    double spread_ticks = argc > 2 ? std::strtod(argv[2], nullptr) : 50.0;
+    std::vector<Order> orders = make_orders(num_orders, spread_ticks);
+    double per_order = static_cast<double>(num_orders);
+
+    // Best of 3 fresh books: page-fault cost is noisy
+    uint64_t add_ns = UINT64_MAX;
+    uint64_t indicative_ns = UINT64_MAX;
+    uint64_t uncross_ns = UINT64_MAX;
+    AuctionResult result{};
+    TradeCount count;
+    size_t bid_levels = 0;
+    size_t ask_levels = 0;
+    size_t left = 0;
+    for (int run = 0; run < 3; ++run) {
+        auto book = std::make_unique<OrderBook>();
+        count = TradeCount();
+        book->set_trade_handler(&TradeCount::on_trade, &count);
+        book->begin_auction();
+
+        uint64_t t0 = bench::now_ns();
+        for (const Order& order : orders) {
+            book->add_order(order);
+        }
+        add_ns = std::min(add_ns, bench::now_ns() - t0);
+        bid_levels = book->bid_levels();
+        ask_levels = book->ask_levels();
+
+        for (int call = 0; call < 10; ++call) {
+            t0 = bench::now_ns();
+            result = book->indicative_uncross(100.0);
+            indicative_ns = std::min(indicative_ns, bench::now_ns() - t0);
+        }
+
+        t0 = bench::now_ns();
+        result = book->uncross(100.0);
+        uncross_ns = std::min(uncross_ns, bench::now_ns() - t0);
+        left = book->bid_levels() + book->ask_levels();
+    }
+
+    std::printf("%zu orders in the call phase, %zu bid / %zu ask levels\n",
+                num_orders, bid_levels, ask_levels);
+    std::printf("  clearing price %.2f, volume %lu (demand %lu, supply %lu)\n", result.price,
+                static_cast<unsigned long>(result.volume),
+                static_cast<unsigned long>(result.buy_quantity),
+                static_cast<unsigned long>(result.sell_quantity));
+    std::printf("  add (accumulate):     %8.1f ns/order\n", static_cast<double>(add_ns) / per_order);
+    std::printf("  indicative_uncross(): %8.1f us\n", static_cast<double>(indicative_ns) / 1e3);
+    std::printf("  uncross():            %8.2f ms for %lu trades (%.1f ns/trade), %zu levels left\n",
+                static_cast<double>(uncross_ns) / 1e6, static_cast<unsigned long>(count.trades),
+                static_cast<double>(uncross_ns) / static_cast<double>(std::max<uint64_t>(count.trades, 1)),
+                left);
+    return count.quantity == result.volume ? 0 : 1;
+}
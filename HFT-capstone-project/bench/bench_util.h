@@ -0,0 +1,39 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include <unistd.h>
+
+// ============================================================================
+// Shared helpers for the standalone benchmark programs
+// ============================================================================
+namespace bench {
+
+inline uint64_t now_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// Resident set size of this process in bytes (0 if /proc is unavailable)
+inline size_t resident_bytes() {
+    FILE* f = std::fopen("/proc/self/statm", "r");
+    if (!f) return 0;
+    unsigned long pages = 0, resident = 0;
+    int fields = std::fscanf(f, "%lu %lu", &pages, &resident);
+    std::fclose(f);
+    if (fields != 2) return 0;
+    return static_cast<size_t>(resident) * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
+
+// Percentile of a sample set (sorts in place)
+inline uint64_t percentile(std::vector<uint64_t>& samples, double pct) {
+    if (samples.empty()) return 0;
+    std::sort(samples.begin(), samples.end());
+    size_t idx = static_cast<size_t>(pct / 100.0 * static_cast<double>(samples.size() - 1));
+    return samples[idx];
+}
+
+}  // namespace bench
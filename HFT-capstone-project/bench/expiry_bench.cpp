@@ -0,0 +1,124 @@
+#include "order_book.h"
+#include "bench_util.h"
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <numeric>
+#include <random>
+
+// GTT expiry benchmark: adds the same resting orders as GTC and as GTT
+// with random expiries, then reports
+//   - the added cost per add of arming the timer
+//   - the cost of cancelling a GTT order (timer disarm) vs a GTC one
+//   - advancing the clock over the whole horizon in fixed steps: time per
+//     expired order, and the slowest single advance_time() call. Expiry
+//     visits the book in random order, so the baseline is cancelling the
+//     same GTC orders in that order.
+//
+//   order_book_expiry_bench [num_orders] [horizon_sec] [step_ms]
+
+static const uint64_t kStart = 1000000000ull;  // Engine clock at the first add
+
+static void build(OrderBook& book, size_t num_orders, const std::vector<uint64_t>& expiries) {
+    for (size_t i = 0; i < num_orders; ++i) {
+        // 1000 bid levels below 100.00 and 1000 ask levels above it: never crosses
+        bool is_buy = (i & 1) == 0;
+        double offset = static_cast<double>(1 + (i >> 1) % 1000) * 0.01;
+        double price = is_buy ? 100.0 - offset : 100.0 + offset;
+        Order order(i + 1, is_buy, price, 100, kStart);
+        if (!expiries.empty()) {
+            order.tif = TimeInForce::Gtt;
+            order.expire_ns = expiries[i];
+        }
+        book.add_order(order);
+    }
+}
+
+// Best of 3 builds into a fresh book: page-fault cost is noisy
+static uint64_t time_build(size_t num_orders, const std::vector<uint64_t>& expiries) {
+    uint64_t best = UINT64_MAX;
+    for (int run = 0; run < 3; ++run) {
+        auto book = std::make_unique<OrderBook>();
+        book->advance_time(kStart);
+        uint64_t t0 = bench::now_ns();
+        build(*book, num_orders, expiries);
+        best = std::min(best, bench::now_ns() - t0);
+    }
+    return best;
+}
+
+// Cancel every order, in the order of `ids`
+static uint64_t time_cancels(size_t num_orders, const std::vector<uint64_t>& expiries,
+                             const std::vector<uint64_t>& ids) {
+    auto book = std::make_unique<OrderBook>();
+    book->advance_time(kStart);
+    build(*book, num_orders, expiries);
+    uint64_t t0 = bench::now_ns();
+    for (uint64_t id : ids) {
+        book->cancel_order(id);
+    }
+    return bench::now_ns() - t0;
+}
+
+int main(int argc, char** argv) {
+    size_t num_orders = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    uint64_t horizon_s = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 3600;
+    uint64_t step_ms = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 100;
+
+    std::mt19937_64 gen(2027);
+    std::uniform_int_distribution<uint64_t> expiry_dist(1, horizon_s * 1000000000ull);
+    std::vector<uint64_t> expiries(num_orders);
+    for (uint64_t& expire_ns : expiries) {
+        expire_ns = kStart + expiry_dist(gen);
+    }
+
+    uint64_t gtc_ns = time_build(num_orders, {});
+    uint64_t gtt_ns = time_build(num_orders, expiries);
+    double per_order = static_cast<double>(num_orders);
+    std::printf("%zu resting orders, expiries uniform over %lu s\n", num_orders,
+                static_cast<unsigned long>(horizon_s));
+    std::printf("  add GTC:          %6.1f ns/order\n", static_cast<double>(gtc_ns) / per_order);
+    std::printf("  add GTT:          %6.1f ns/order (+%.1f ns to arm the timer)\n",
+                static_cast<double>(gtt_ns) / per_order,
+                (static_cast<double>(gtt_ns) - static_cast<double>(gtc_ns)) / per_order);
+
+    std::vector<uint64_t> by_id(num_orders);
+    std::iota(by_id.begin(), by_id.end(), 1);
+    std::vector<uint64_t> by_expiry = by_id;
+    std::sort(by_expiry.begin(), by_expiry.end(),
+              [&](uint64_t a, uint64_t b) { return expiries[a - 1] < expiries[b - 1]; });
+    uint64_t gtc_cancel_ns = time_cancels(num_orders, {}, by_id);
+    uint64_t gtt_cancel_ns = time_cancels(num_orders, expiries, by_id);
+    uint64_t random_cancel_ns = time_cancels(num_orders, {}, by_expiry);
+    std::printf("  cancel GTC:       %6.1f ns/order\n", static_cast<double>(gtc_cancel_ns) / per_order);
+    std::printf("  cancel GTT:       %6.1f ns/order\n", static_cast<double>(gtt_cancel_ns) / per_order);
+    std::printf("  cancel GTC in expiry order: %6.1f ns/order\n",
+                static_cast<double>(random_cancel_ns) / per_order);
+
+    // Walk the clock across the horizon; every order expires exactly once
+    auto book = std::make_unique<OrderBook>();
+    book->advance_time(kStart);
+    build(*book, num_orders, expiries);
+    std::vector<uint64_t> step_samples;
+    size_t expired = 0;
+    uint64_t total_ns = 0;
+    uint64_t end = kStart + horizon_s * 1000000000ull + 1000;
+    for (uint64_t now = kStart + step_ms * 1000000ull; ; now += step_ms * 1000000ull) {
+        uint64_t t0 = bench::now_ns();
+        expired += book->advance_time(std::min(now, end));
+        uint64_t elapsed = bench::now_ns() - t0;
+        total_ns += elapsed;
+        step_samples.push_back(elapsed);
+        if (now >= end) break;
+    }
+    std::printf("  expire:           %6.1f ns/order over %zu advance_time() calls "
+                "(%zu expired, %zu left)\n",
+                static_cast<double>(total_ns) / static_cast<double>(std::max<size_t>(expired, 1)),
+                step_samples.size(), expired, book->pending_expiries());
+    uint64_t p50 = bench::percentile(step_samples, 50);
+    uint64_t p99 = bench::percentile(step_samples, 99);
+    std::printf("  advance_time():   p50 %lu ns | p99 %lu ns | max %lu ns\n",
+                static_cast<unsigned long>(p50), static_cast<unsigned long>(p99),
+                static_cast<unsigned long>(step_samples.back()));
+    return expired == num_orders ? 0 : 1;
+}
@@ -0,0 +1,96 @@
+#include "mbo_feed.h"
+#include "bench_util.h"
+
+// Sustained-rate benchmark for the MBO feed handler. Records a synthetic
+// venue stream to a file once, then replays the file through
+// MboFeedHandler into a passive OrderBook and, for comparison, straight
+// into a matching-mode book (the handler only drives passive books, so
+// the messages map onto add/amend/cancel/reduce there and no sequence
+// check runs), reporting messages per second and ns per message.
+//
+//   order_book_feed_bench [stream_file] [num_messages]
+
+static void print_row(const char* label, size_t messages, uint64_t elapsed, uint64_t gaps,
+                      uint64_t unknown, size_t resting) {
+    double seconds = static_cast<double>(elapsed) / 1e9;
+    std::printf("%8s | %9.2f | %6.1f | %4lu | %7lu | %7zu\n",
+                label,
+                static_cast<double>(messages) / seconds / 1e6,
+                static_cast<double>(elapsed) / static_cast<double>(messages),
+                static_cast<unsigned long>(gaps),
+                static_cast<unsigned long>(unknown),
+                resting);
+}
+
+static void run_passive(const std::vector<MboMessage>& stream) {
+    OrderBook book(BookMode::Passive);
+    book.set_trade_handler([](const Trade&, void*) {}, nullptr);
+    MboFeedHandler handler(book);
+
+    uint64_t start = bench::now_ns();
+    for (const MboMessage& msg : stream) {
+        handler.on_message(msg);
+    }
+    uint64_t elapsed = bench::now_ns() - start;
+
+    const MboFeedHandler::Stats& stats = handler.stats();
+    print_row("passive", stream.size(), elapsed, stats.gaps, stats.unknown_orders,
+              book.pool_stats().live);
+}
+
+static void run_matching(const std::vector<MboMessage>& stream) {
+    OrderBook book(BookMode::Matching);
+    book.set_trade_handler([](const Trade&, void*) {}, nullptr);
+    uint64_t unknown = 0;
+
+    uint64_t start = bench::now_ns();
+    for (const MboMessage& msg : stream) {
+        bool known = true;
+        switch (msg.type) {
+            case MboMessageType::Add:
+                book.add_order(Order(msg.order_id, msg.is_buy != 0, msg.price, msg.quantity, msg.seq));
+                break;
+            case MboMessageType::Modify:
+                known = book.amend_order(msg.order_id, msg.price, msg.quantity);
+                break;
+            case MboMessageType::Delete:
+                known = book.cancel_order(msg.order_id);
+                break;
+            case MboMessageType::Execute:
+                known = book.reduce_order(msg.order_id, msg.quantity);
+                break;
+        }
+        unknown += known ? 0 : 1;
+    }
+    uint64_t elapsed = bench::now_ns() - start;
+
+    print_row("matching", stream.size(), elapsed, 0, unknown, book.pool_stats().live);
+}
+
+int main(int argc, char* argv[]) {
+    std::string path = argc > 1 ? argv[1] : "mbo_stream.bin";
+    size_t num_messages = argc > 2 ? static_cast<size_t>(std::strtoull(argv[2], nullptr, 10))
+                                   : 5000000;
+
+    std::vector<MboMessage> stream;
+    if (!read_mbo_file(path, stream) || stream.size() != num_messages) {
+        std::printf("Recording %zu messages to %s...\n", num_messages, path.c_str());
+        generate_mbo_stream(num_messages, 2027, stream);
+        if (!write_mbo_file(path, stream)) {
+            std::fprintf(stderr, "Failed to write %s\n", path.c_str());
+            return 1;
+        }
+        stream.clear();
+        if (!read_mbo_file(path, stream)) {
+            std::fprintf(stderr, "Failed to read back %s\n", path.c_str());
+            return 1;
+        }
+    }
+
+    std::printf("Replaying %zu messages from %s\n\n", stream.size(), path.c_str());
+    std::printf("    mode |  M msgs/s | ns/msg | gaps | unknown | resting\n");
+    std::printf("---------+-----------+--------+------+---------+--------\n");
+    run_passive(stream);
+    run_matching(stream);
+    return 0;
+}
@@ -0,0 +1,123 @@
+#include "journal.h"
+#include "bench_util.h"
+#include <random>
+
+// Journaling overhead: drives the same order flow through a book with and
+// without a Journal under each durability policy and reports the extra
+// ns per input on the book thread, plus the time for the writer to drain.
+//
+//   order_book_journal_bench [journal_dir] [num_inputs]
+
+struct Input {
+    JournalOp op;
+    Order order;
+};
+
+static std::vector<Input> make_flow(size_t count) {
+    std::mt19937 gen(33);
+    std::uniform_int_distribution<int> action_dist(0, 9);
+    std::uniform_int_distribution<int> tick_dist(1, 200);
+    std::uniform_int_distribution<uint64_t> qty_dist(1, 1000);
+
+    std::vector<Input> flow;
+    flow.reserve(count);
+    uint64_t next_id = 1;
+    for (size_t i = 0; i < count; ++i) {
+        int action = action_dist(gen);
+        if (action < 6 || next_id < 100) {
+            bool is_buy = (gen() & 1) == 0;
+            double offset = tick_dist(gen) * 0.01;
+            double price = is_buy ? 100.0 - offset : 100.0 + offset;
+            flow.push_back({JournalOp::Add, Order(next_id++, is_buy, price, qty_dist(gen), i)});
+        } else {
+            uint64_t id = 1 + gen() % (next_id - 1);
+            if (action < 9) {
+                flow.push_back({JournalOp::Cancel, Order(id, true, 0.0, 0, i)});
+            } else {
+                flow.push_back({JournalOp::Amend, Order(id, true, 0.0, qty_dist(gen), i)});
+            }
+        }
+    }
+    return flow;
+}
+
+// Returns ns spent on the book thread
+static uint64_t drive(const std::vector<Input>& flow, Journal* journal) {
+    OrderBook book;
+    book.set_trade_handler([](const Trade&, void*) {}, nullptr);
+
+    uint64_t start = bench::now_ns();
+    for (const Input& in : flow) {
+        switch (in.op) {
+            case JournalOp::Add:
+                book.add_order(in.order);
+                if (journal) journal->record_add(in.order);
+                break;
+            case JournalOp::Cancel:
+                if (book.cancel_order(in.order.order_id) && journal) {
+                    journal->record_cancel(in.order.order_id);
+                }
+                break;
+            case JournalOp::Amend: {
+                Order current;
+                if (book.get_order(in.order.order_id, current) &&
+                    book.amend_order(in.order.order_id, current.price, in.order.quantity) && journal) {
+                    journal->record_amend(in.order.order_id, current.price, in.order.quantity);
+                }
+                break;
+            }
+            case JournalOp::AddStop:
+            case JournalOp::Clock:
+            case JournalOp::AuctionStart:
+            case JournalOp::Uncross:
+                break;  // Not generated
+        }
+    }
+    return bench::now_ns() - start;
+}
+
+int main(int argc, char* argv[]) {
+    std::string dir = argc > 1 ? argv[1] : ".";
+    size_t count = argc > 2 ? static_cast<size_t>(std::strtoull(argv[2], nullptr, 10)) : 200000;
+    std::vector<Input> flow = make_flow(count);
+
+    uint64_t base_ns = drive(flow, nullptr);
+    std::printf("%zu inputs, no journal: %.1f ns/input\n\n", count,
+                static_cast<double>(base_ns) / static_cast<double>(count));
+    std::printf("      policy | ns/input | overhead ns | drain ms | records\n");
+    std::printf("-------------+----------+-------------+----------+--------\n");
+
+    struct Case { DurabilityPolicy policy; const char* name; };
+    const Case cases[] = {
+        {DurabilityPolicy::Async, "async"},
+        {DurabilityPolicy::GroupCommit, "group-commit"},
+        {DurabilityPolicy::PerMessage, "per-message"},
+    };
+
+    for (const Case& c : cases) {
+        std::string path = dir + "/journal_bench.bin";
+        ::unlink(path.c_str());
+
+        JournalConfig config;
+        config.policy = c.policy;
+        uint64_t book_ns = 0;
+        uint64_t drain_ns = 0;
+        uint64_t records = 0;
+        {
+            Journal journal(path, config);
+            book_ns = drive(flow, &journal);
+            records = journal.last_seq();
+            uint64_t drain_start = bench::now_ns();
+            journal.wait_durable(records);
+            drain_ns = bench::now_ns() - drain_start;
+        }
+
+        std::printf("%12s | %8.1f | %11.1f | %8.1f | %7lu\n", c.name,
+                    static_cast<double>(book_ns) / static_cast<double>(count),
+                    (static_cast<double>(book_ns) - static_cast<double>(base_ns)) / static_cast<double>(count),
+                    static_cast<double>(drain_ns) / 1e6,
+                    static_cast<unsigned long>(records));
+        ::unlink(path.c_str());
+    }
+    return 0;
+}
@@ -0,0 +1,595 @@
+#include "order_book.h"
+#include "order_flow.h"
+#include "perf_counters.h"
+#include <benchmark/benchmark.h>
+#include <chrono>
+#include <memory>
+
+// Google Benchmark microbenchmarks for the order book hot paths. Every
+// benchmark reports ns/op (time) and ops/s (items_per_second); run with
+//
+//   order_book_bench --benchmark_format=json --benchmark_out=bench.json
+//
+// (or `cmake --build . --target order_book_bench_json`) to get a JSON
+// report for regression tracking. Where the PMU is reachable, hardware
+// counters are added per iteration (cycles, instructions, cache, branch and
+// dTLB misses); page faults and context switches are always reported.
+
+namespace {
+
+constexpr double kMid = 100.0;
+constexpr double kTick = 0.01;
+
+template<typename Book>
+void silence_trades(Book& book) {
+    book.set_trade_handler([](const Trade&, void*) {}, nullptr);
+}
+
+double bid_price(int64_t level) { return kMid - static_cast<double>(level + 1) * kTick; }
+double ask_price(int64_t level) { return kMid + static_cast<double>(level + 1) * kTick; }
+
+// `levels` bid and ask levels, `per_level` orders each; returns next free id
+uint64_t fill_book(OrderBook& book, int64_t levels, int64_t per_level) {
+    uint64_t id = 1;
+    for (int64_t l = 0; l < levels; ++l) {
+        for (int64_t i = 0; i < per_level; ++i) {
+            book.add_order(Order(id++, true, bid_price(l), 100, 0));
+            book.add_order(Order(id++, false, ask_price(l), 100, 0));
+        }
+    }
+    return id;
+}
+
+// Counts perf events over a benchmark's timed loop and attaches them to
+// the result as per-iteration counters. Mirror PauseTiming() with pause().
+class PerfScope {
+private:
+    benchmark::State& state_;
+    bench::PerfCounters counters_;
+
+public:
+    explicit PerfScope(benchmark::State& state) : state_(state) { counters_.start(); }
+
+    ~PerfScope() {
+        counters_.stop();
+        for (int i = 0; i < bench::PerfCounters::kEventCount; ++i) {
+            auto event = static_cast<bench::PerfCounters::Event>(i);
+            if (counters_.available(event)) {
+                state_.counters[bench::PerfCounters::name(event)] =
+                    benchmark::Counter(counters_.value(event), benchmark::Counter::kAvgIterations);
+            }
+        }
+    }
+
+    void pause() {
+        counters_.pause();
+        state_.PauseTiming();
+    }
+
+    void resume() {
+        state_.ResumeTiming();
+        counters_.resume();
+    }
+
+    PerfScope(const PerfScope&) = delete;
+    PerfScope& operator=(const PerfScope&) = delete;
+};
+
+}  // namespace
+
+// ============================================================================
+// Add: passive add into a book of N levels per side
+// ============================================================================
+static void BM_AddPassive(benchmark::State& state) {
+    const int64_t depth = state.range(0);
+    OrderBook book;
+    silence_trades(book);
+    uint64_t id = fill_book(book, depth, 1);
+
+    int64_t level = 0;
+    PerfScope perf(state);
+    for (auto _ : state) {
+        book.add_order(Order(id++, true, bid_price(level), 100, 0));
+        if (++level == depth) level = 0;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_AddPassive)->RangeMultiplier(10)->Range(1, 10000);
+
+// Add that opens a new level each time (tree insert), book of N levels
+static void BM_AddNewLevel(benchmark::State& state) {
+    const int64_t depth = state.range(0);
+    OrderBook book;
+    silence_trades(book);
+    uint64_t id = fill_book(book, depth, 1);
+
+    // New levels below the existing depth; cancel to keep the book size steady
+    int64_t level = depth;
+    PerfScope perf(state);
+    for (auto _ : state) {
+        uint64_t order_id = id++;
+        book.add_order(Order(order_id, true, bid_price(level), 100, 0));
+        perf.pause();
+        book.cancel_order(order_id);
+        if (++level == 2 * depth + 1) level = depth;
+        perf.resume();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_AddNewLevel)->RangeMultiplier(10)->Range(1, 10000);
+
+// ============================================================================
+// Cancel: position within one level of 2 * batch orders
+// ============================================================================
+// 0 = head (FIFO order), 1 = interior (batch / 2 orders on either side), 2 = tail
+static void BM_CancelPosition(benchmark::State& state) {
+    const int64_t position = state.range(0);
+    const uint64_t batch = 1000;
+    OrderBook book;
+    silence_trades(book);
+
+    uint64_t base = 1;
+    uint64_t done = batch;  // Forces a refill on the first iteration
+    PerfScope perf(state);
+    for (auto _ : state) {
+        if (done == batch) {
+            perf.pause();
+            book.clear();
+            base = 1;
+            for (uint64_t i = 0; i < 2 * batch; ++i) {
+                book.add_order(Order(base + i, true, kMid, 100, 0));
+            }
+            done = 0;
+            perf.resume();
+        }
+        uint64_t id = position == 0 ? base + done
+                    : position == 1 ? base + batch / 2 + done
+                                    : base + 2 * batch - 1 - done;
+        benchmark::DoNotOptimize(book.cancel_order(id));
+        done++;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_CancelPosition)->DenseRange(0, 2)->ArgName("head0_mid1_tail2");
+
+// ============================================================================
+// Amend: quantity in place vs price change (node relinked to the new level)
+// ============================================================================
+static void BM_AmendQuantity(benchmark::State& state) {
+    OrderBook book;
+    silence_trades(book);
+    uint64_t next_id = fill_book(book, 100, 10);
+    const uint64_t num_ids = next_id - 1;
+
+    uint64_t i = 0;
+    PerfScope perf(state);
+    for (auto _ : state) {
+        uint64_t id = 1 + (i % num_ids);
+        // Bids have odd ids; keep each order at its own price
+        double price = (id & 1) ? bid_price(static_cast<int64_t>((id - 1) / 20))
+                                : ask_price(static_cast<int64_t>((id - 1) / 20));
+        benchmark::DoNotOptimize(book.amend_order(id, price, 50 + (i & 63)));
+        i += 7919;  // Stride through the book
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_AmendQuantity);
+
+static void BM_AmendPrice(benchmark::State& state) {
+    OrderBook book;
+    silence_trades(book);
+    fill_book(book, 100, 10);
+    // One bid that hops between two passive levels
+    const uint64_t id = 1u << 30;
+    book.add_order(Order(id, true, bid_price(50), 100, 0));
+
+    bool flip = false;
+    PerfScope perf(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(book.amend_order(id, bid_price(flip ? 50 : 60), 100));
+        flip = !flip;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_AmendPrice);
+
+// Market-maker flow: 100 levels of 10 orders per side, and every iteration
+// amends one of them, striding through the book: a cut (keeps priority),
+// an increase (back of the level) or a one-tick move away from the mid.
+// Orders drift outwards by at most a tick per visit.
+static void BM_AmendFlow(benchmark::State& state) {
+    OrderBook book;
+    silence_trades(book);
+    uint64_t next_id = fill_book(book, 100, 10);
+    const uint64_t num_ids = next_id - 1;
+
+    uint64_t i = 0;
+    Order order(0, true, kMid, 0, 0);
+    PerfScope perf(state);
+    for (auto _ : state) {
+        uint64_t id = 1 + (i % num_ids);
+        book.get_order(id, order);
+        double price = order.price;
+        uint64_t quantity = order.quantity;
+        switch (i % 3) {
+            case 0: quantity = quantity > 1 ? quantity - 1 : 100; break;
+            case 1: quantity += 1; break;
+            default: price += order.is_buy ? -kTick : kTick; break;
+        }
+        benchmark::DoNotOptimize(book.amend_order(id, price, quantity));
+        i += 7919;  // Stride through the book
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_AmendFlow);
+
+// ============================================================================
+// Sweep: one aggressive order that clears N ask levels
+// ============================================================================
+// The refill between sweeps is excluded with manual timing: PauseTiming()
+// costs more than a short sweep. The sweep leaves a 10-level bid book and
+// the asks behind the swept levels in place, as a live book would.
+static void BM_Sweep(benchmark::State& state) {
+    const int64_t levels = state.range(0);
+    const int64_t per_level = 4;
+    OrderBook book;
+    silence_trades(book);
+    uint64_t id = fill_book(book, 10, 1);
+    for (int64_t l = levels; l < levels + 10; ++l) {
+        book.add_order(Order(id++, false, ask_price(l), 100, 0));
+    }
+
+    PerfScope perf(state);
+    for (auto _ : state) {
+        perf.pause();
+        for (int64_t l = 0; l < levels; ++l) {
+            for (int64_t i = 0; i < per_level; ++i) {
+                book.add_order(Order(id++, false, ask_price(l), 100, 0));
+            }
+        }
+        perf.resume();
+        auto start = std::chrono::steady_clock::now();
+        book.add_order(Order(id++, true, ask_price(levels - 1),
+                             static_cast<uint64_t>(levels * per_level * 100), 0));
+        auto stop = std::chrono::steady_clock::now();
+        state.SetIterationTime(std::chrono::duration<double>(stop - start).count());
+    }
+    state.SetItemsProcessed(state.iterations() * levels);  // Levels swept per second
+    state.counters["levels"] = static_cast<double>(levels);
+}
+BENCHMARK(BM_Sweep)->RangeMultiplier(10)->Range(1, 1000)->UseManualTime();
+
+// ============================================================================
+// Crossing workload: a generated flow with a quarter of its inputs priced
+// through the mid, replayed into a fresh book per iteration. Arg 1 gives
+// every order a participant and CancelNewest STP, with buyers and sellers
+// disjoint so the check runs against every resting order it meets but never
+// fires: the cost of self-trade prevention in the common case.
+// ============================================================================
+static void BM_CrossingFlow(benchmark::State& state) {
+    const bool stp = state.range(0) != 0;
+    OrderFlowConfig config;
+    config.num_messages = 200000;
+    config.add_weight = 40;
+    config.aggressive_weight = 25;
+    std::vector<JournalRecord> flow;
+    generate_order_flow(config, flow);
+
+    PerfScope perf(state);
+    for (auto _ : state) {
+        auto book = std::make_unique<OrderBook>();
+        silence_trades(*book);
+        for (const JournalRecord& record : flow) {
+            switch (record.op) {
+                case JournalOp::Add: {
+                    Order order(record.order_id, record.is_buy != 0, record.price,
+                                record.quantity, record.timestamp_ns);
+                    if (stp) {
+                        order.participant_id = static_cast<uint32_t>(
+                            1 + 2 * (record.order_id % 32) + (record.is_buy ? 0 : 1));
+                        order.stp = StpMode::CancelNewest;
+                    }
+                    book->add_order(order);
+                    break;
+                }
+                case JournalOp::Cancel:
+                    book->cancel_order(record.order_id);
+                    break;
+                case JournalOp::Amend:
+                    book->amend_order(record.order_id, record.price, record.quantity);
+                    break;
+                default:
+                    break;
+            }
+        }
+        benchmark::DoNotOptimize(book->bid_levels());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(flow.size()));
+}
+BENCHMARK(BM_CrossingFlow)->Arg(0)->Arg(1);
+
+// ============================================================================
+// Aggressive order filled in full against one large resting order
+// ============================================================================
+// Arg: 0 = limit GTC, 1 = limit IOC, 2 = limit FOK, 3 = market IOC
+static void BM_AggressiveFill(benchmark::State& state) {
+    static constexpr OrderType kTypes[] = {OrderType::Limit, OrderType::Limit,
+                                           OrderType::Limit, OrderType::Market};
+    static constexpr TimeInForce kTifs[] = {TimeInForce::Gtc, TimeInForce::Ioc,
+                                            TimeInForce::Fok, TimeInForce::Ioc};
+    const OrderType type = kTypes[state.range(0)];
+    const TimeInForce tif = kTifs[state.range(0)];
+    OrderBook book;
+    silence_trades(book);
+    uint64_t id = fill_book(book, 10, 1);
+    book.add_order(Order(id++, false, kMid, std::numeric_limits<uint64_t>::max() / 2, 0));
+
+    PerfScope perf(state);
+    for (auto _ : state) {
+        book.add_order(Order(id++, true, kMid, 1, 0, type, tif));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_AggressiveFill)->DenseRange(0, 3);
+
+// IOC that finds nothing to trade (price below the best ask): a reject
+// with no book change
+static void BM_IocNoFill(benchmark::State& state) {
+    OrderBook book;
+    silence_trades(book);
+    uint64_t id = fill_book(book, 10, 1);
+
+    PerfScope perf(state);
+    for (auto _ : state) {
+        book.add_order(Order(id++, true, kMid, 1, 0, OrderType::Limit, TimeInForce::Ioc));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_IocNoFill);
+
+// ============================================================================
+// Matching policies: a level of N resting asks, four participants in turn,
+// hit by a buy of 10 lots per order, so every policy but FIFO runs its
+// allocation pass over the whole level. The first ask (the top order) is
+// used up on the first iteration; after that the level never drains.
+// LmmPolicy gives participant 1 a 40% share.
+// ============================================================================
+template<typename Policy>
+static void BM_PolicyFill(benchmark::State& state) {
+    const int64_t orders = state.range(0);
+    const uint64_t quantity = static_cast<uint64_t>(orders) * 10;
+    BasicOrderBook<Policy> book;
+    silence_trades(book);
+    if constexpr (Policy::kLmm) {
+        book.policy().participant = 1;
+        book.policy().percent = 40;
+    }
+    uint64_t id = 1;
+    for (int64_t i = 0; i < orders; ++i) {
+        uint64_t size = i == 0 ? quantity : 1000000000000ull + static_cast<uint64_t>(i) * 1000;
+        Order resting(id++, false, kMid, size, 0);
+        resting.participant_id = static_cast<uint32_t>(1 + i % 4);
+        book.add_order(resting);
+    }
+
+    PerfScope perf(state);
+    for (auto _ : state) {
+        book.add_order(Order(id++, true, kMid, quantity, 0));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_PolicyFill, FifoPolicy)->Arg(10)->Arg(100)->Arg(1000);
+BENCHMARK_TEMPLATE(BM_PolicyFill, ProRataPolicy)->Arg(10)->Arg(100)->Arg(1000);
+BENCHMARK_TEMPLATE(BM_PolicyFill, TopOrderProRataPolicy)->Arg(10)->Arg(100)->Arg(1000);
+BENCHMARK_TEMPLATE(BM_PolicyFill, LmmPolicy)->Arg(10)->Arg(100)->Arg(1000);
+
+// ============================================================================
+// Arrival checks: rejected orders, and the accepted adds they compare with
+// ============================================================================
+// Arg: 0 = post-only buy at the best ask, 1 = buy 1.00 through the best
+// ask with a 0.50 band. Both are rejected from the cached top of book.
+static void BM_RejectOnArrival(benchmark::State& state) {
+    const bool band = state.range(0) == 1;
+    OrderBook book;
+    silence_trades(book);
+    uint64_t id = fill_book(book, 10, 1);
+    book.set_price_band(0.50);
+    const OrderType type = band ? OrderType::Limit : OrderType::PostOnly;
+    const double price = band ? ask_price(0) + 1.0 : ask_price(0);
+
+    PerfScope perf(state);
+    for (auto _ : state) {
+        book.add_order(Order(id++, true, price, 1, 0, type));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RejectOnArrival)->DenseRange(0, 1)->ArgName("post_only0_band1");
+
+// Post-only buy that does not cross, vs one slid to one tick under the best
+// ask; both join the back of one level, as BM_AddPassive does
+static void BM_PostOnlyRest(benchmark::State& state) {
+    const bool slide = state.range(0) == 1;
+    OrderBook book;
+    silence_trades(book);
+    uint64_t id = fill_book(book, 10, 1);
+    const OrderType type = slide ? OrderType::PostOnlySlide : OrderType::PostOnly;
+    const double price = slide ? ask_price(0) : bid_price(0);
+
+    PerfScope perf(state);
+    for (auto _ : state) {
+        book.add_order(Order(id++, true, price, 1, 0, type));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PostOnlyRest)->DenseRange(0, 1)->ArgName("passive0_slide1");
+
+// ============================================================================
+// Iceberg replenishment: a level of N icebergs showing 10 each; every
+// aggressive order takes exactly one slice, so each iteration is a fill, a
+// slice cut from the reserve and a relink to the back of the level
+// ============================================================================
+static void BM_IcebergFill(benchmark::State& state) {
+    const int64_t icebergs = state.range(0);
+    OrderBook book;
+    silence_trades(book);
+    uint64_t id = fill_book(book, 10, 1);
+    for (int64_t i = 0; i < icebergs; ++i) {
+        Order iceberg(id++, false, kMid, std::numeric_limits<uint64_t>::max() / 4, 0);
+        iceberg.display_quantity = 10;
+        book.add_order(iceberg);
+    }
+
+    PerfScope perf(state);
+    for (auto _ : state) {
+        book.add_order(Order(id++, true, kMid, 10, 0));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_IcebergFill)->Arg(1)->Arg(10)->Arg(100);
+
+// The same traffic with the reserve managed outside the book: each filled
+// slice is freed and a new 10-lot is added at the back under a new id
+static void BM_IcebergEmulated(benchmark::State& state) {
+    const int64_t icebergs = state.range(0);
+    OrderBook book;
+    silence_trades(book);
+    uint64_t id = fill_book(book, 10, 1);
+    for (int64_t i = 0; i < icebergs; ++i) {
+        book.add_order(Order(id++, false, kMid, 10, 0));
+    }
+
+    PerfScope perf(state);
+    for (auto _ : state) {
+        book.add_order(Order(id++, true, kMid, 10, 0));
+        book.add_order(Order(id++, false, kMid, 10, 0));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_IcebergEmulated)->Arg(1)->Arg(10)->Arg(100);
+
+// ============================================================================
+// Stop trigger overhead: 1-lot fills at the mid with N pending stops spread
+// over 1000 trigger prices per side, all out of reach. Each trade costs one
+// cached-trigger check whatever N is.
+// ============================================================================
+static uint64_t add_far_stops(OrderBook& book, uint64_t id, int64_t count) {
+    for (int64_t i = 0; i < count; ++i) {
+        int64_t ticks = 100 + i % 1000;
+        bool is_buy = (i & 1) == 0;
+        double trigger = is_buy ? kMid + static_cast<double>(ticks) * kTick
+                                : kMid - static_cast<double>(ticks) * kTick;
+        book.add_stop_order(Order(id++, is_buy, 0.0, 1, 0, OrderType::Market), trigger);
+    }
+    return id;
+}
+
+static void BM_TradeWithStops(benchmark::State& state) {
+    OrderBook book;
+    silence_trades(book);
+    uint64_t id = fill_book(book, 10, 1);
+    book.add_order(Order(id++, false, kMid, std::numeric_limits<uint64_t>::max() / 2, 0));
+    id = add_far_stops(book, id, state.range(0));
+
+    PerfScope perf(state);
+    for (auto _ : state) {
+        book.add_order(Order(id++, true, kMid, 1, 0));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TradeWithStops)->Arg(0)->Arg(100000);
+
+// Every iteration parks a buy stop at the mid and prints a 1-lot trade
+// there, which triggers it: the stop's market order is a second fill
+static void BM_StopTrigger(benchmark::State& state) {
+    OrderBook book;
+    silence_trades(book);
+    uint64_t id = fill_book(book, 10, 1);
+    book.add_order(Order(id++, false, kMid, std::numeric_limits<uint64_t>::max() / 2, 0));
+    id = add_far_stops(book, id, state.range(0));
+
+    PerfScope perf(state);
+    for (auto _ : state) {
+        book.add_stop_order(Order(id++, true, 0.0, 1, 0, OrderType::Market), kMid);
+        book.add_order(Order(id++, true, kMid, 1, 0));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_StopTrigger)->Arg(0)->Arg(100000);
+
+// ============================================================================
+// Snapshot at varying depth (book of 1000 levels per side)
+// ============================================================================
+static void BM_Snapshot(benchmark::State& state) {
+    const size_t depth = static_cast<size_t>(state.range(0));
+    OrderBook book;
+    silence_trades(book);
+    fill_book(book, 1000, 2);
+
+    std::vector<PriceLevel> bids, asks;
+    bids.reserve(depth);
+    asks.reserve(depth);
+    PerfScope perf(state);
+    for (auto _ : state) {
+        book.get_snapshot(depth, bids, asks);
+        benchmark::DoNotOptimize(bids.data());
+        benchmark::DoNotOptimize(asks.data());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Snapshot)->Arg(1)->Arg(5)->Arg(10)->Arg(50)->Arg(100)->Arg(1000);
+
+// ============================================================================
+// MemoryPool vs the global allocator
+// ============================================================================
+struct PoolElement {
+    uint64_t payload[6];  // Same footprint as an order node
+};
+
+static void BM_PoolAllocFree(benchmark::State& state) {
+    MemoryPool<PoolElement, 4096> pool;
+    PerfScope perf(state);
+    for (auto _ : state) {
+        PoolHandle h = pool.allocate();
+        benchmark::DoNotOptimize(pool[h]);
+        pool.deallocate(h);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PoolAllocFree);
+
+static void BM_PoolBurst(benchmark::State& state) {
+    const size_t burst = static_cast<size_t>(state.range(0));
+    MemoryPool<PoolElement, 4096> pool;
+    std::vector<PoolHandle> handles(burst);
+    PerfScope perf(state);
+    for (auto _ : state) {
+        for (size_t i = 0; i < burst; ++i) {
+            handles[i] = pool.allocate();
+        }
+        benchmark::ClobberMemory();
+        for (size_t i = 0; i < burst; ++i) {
+            pool.deallocate(handles[i]);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(burst));
+}
+BENCHMARK(BM_PoolBurst)->RangeMultiplier(16)->Range(16, 65536);
+
+static void BM_NewDeleteBurst(benchmark::State& state) {
+    const size_t burst = static_cast<size_t>(state.range(0));
+    std::vector<PoolElement*> elements(burst);
+    PerfScope perf(state);
+    for (auto _ : state) {
+        for (size_t i = 0; i < burst; ++i) {
+            elements[i] = new PoolElement();
+        }
+        benchmark::ClobberMemory();
+        for (size_t i = 0; i < burst; ++i) {
+            delete elements[i];
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(burst));
+}
+BENCHMARK(BM_NewDeleteBurst)->RangeMultiplier(16)->Range(16, 65536);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,195 @@
+#pragma once
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// ============================================================================
+// Hardware performance counters for the benchmark programs (perf_event_open)
+// ============================================================================
+// Counts user-space events of this thread around a benchmark phase:
+//
+//     bench::PerfCounters perf;
+//     perf.start();
+//     ... phase ...
+//     perf.stop();
+//     perf.report("add", num_adds);   // events per operation
+//
+// Each event is opened on its own (not as a group) so that one unsupported
+// counter does not take the others down. Inside VMs and containers the PMU
+// is often missing or perf_event_open is blocked; unavailable events report
+// "n/a" and the software events (page faults, context switches) still work.
+// Values are scaled when the kernel multiplexed a counter.
+namespace bench {
+
+class PerfCounters {
+public:
+    enum Event {
+        Cycles,
+        Instructions,
+        L1dMisses,
+        LlcMisses,
+        BranchMisses,
+        DtlbMisses,
+        PageFaults,
+        ContextSwitches,
+        kEventCount
+    };
+
+private:
+    int fds_[kEventCount];
+    double values_[kEventCount];
+    int open_errno_;  // errno of the first failed hardware event
+
+    static long perf_event_open(perf_event_attr* attr) {
+        return syscall(SYS_perf_event_open, attr, 0, -1, -1, 0);
+    }
+
+    static uint64_t cache_config(uint64_t cache, uint64_t op, uint64_t result) {
+        return cache | (op << 8) | (result << 16);
+    }
+
+    static void describe(Event event, __u32& type, __u64& config) {
+        switch (event) {
+            case Cycles:
+                type = PERF_TYPE_HARDWARE;
+                config = PERF_COUNT_HW_CPU_CYCLES;
+                break;
+            case Instructions:
+                type = PERF_TYPE_HARDWARE;
+                config = PERF_COUNT_HW_INSTRUCTIONS;
+                break;
+            case L1dMisses:
+                type = PERF_TYPE_HW_CACHE;
+                config = cache_config(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ,
+                                      PERF_COUNT_HW_CACHE_RESULT_MISS);
+                break;
+            case LlcMisses:
+                type = PERF_TYPE_HARDWARE;
+                config = PERF_COUNT_HW_CACHE_MISSES;
+                break;
+            case BranchMisses:
+                type = PERF_TYPE_HARDWARE;
+                config = PERF_COUNT_HW_BRANCH_MISSES;
+                break;
+            case DtlbMisses:
+                type = PERF_TYPE_HW_CACHE;
+                config = cache_config(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ,
+                                      PERF_COUNT_HW_CACHE_RESULT_MISS);
+                break;
+            case PageFaults:
+                type = PERF_TYPE_SOFTWARE;
+                config = PERF_COUNT_SW_PAGE_FAULTS;
+                break;
+            default:
+                type = PERF_TYPE_SOFTWARE;
+                config = PERF_COUNT_SW_CONTEXT_SWITCHES;
+                break;
+        }
+    }
+
+    void control(unsigned long request) {
+        for (int fd : fds_) {
+            if (fd >= 0) ioctl(fd, request, 0);
+        }
+    }
+
+public:
+    PerfCounters() : open_errno_(0) {
+        for (int i = 0; i < kEventCount; ++i) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            describe(static_cast<Event>(i), attr.type, attr.config);
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;  // Allowed at perf_event_paranoid <= 2
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+            fds_[i] = static_cast<int>(perf_event_open(&attr));
+            if (fds_[i] < 0 && attr.type != PERF_TYPE_SOFTWARE && open_errno_ == 0) {
+                open_errno_ = errno;
+            }
+            values_[i] = 0.0;
+        }
+    }
+
+    ~PerfCounters() {
+        for (int fd : fds_) {
+            if (fd >= 0) close(fd);
+        }
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool available(Event event) const { return fds_[event] >= 0; }
+    bool hardware_available() const { return available(Cycles) || available(Instructions); }
+
+    // Zero and start every counter
+    void start() {
+        control(PERF_EVENT_IOC_RESET);
+        control(PERF_EVENT_IOC_ENABLE);
+    }
+
+    // Exclude setup work inside a phase (counts are kept)
+    void pause() { control(PERF_EVENT_IOC_DISABLE); }
+    void resume() { control(PERF_EVENT_IOC_ENABLE); }
+
+    // Stop and latch the totals for value()/report()
+    void stop() {
+        control(PERF_EVENT_IOC_DISABLE);
+        for (int i = 0; i < kEventCount; ++i) {
+            values_[i] = 0.0;
+            if (fds_[i] < 0) continue;
+            uint64_t data[3] = {0, 0, 0};  // value, time enabled, time running
+            if (read(fds_[i], data, sizeof(data)) != static_cast<ssize_t>(sizeof(data))) {
+                continue;
+            }
+            values_[i] = data[2] > 0 ? static_cast<double>(data[0]) *
+                                           static_cast<double>(data[1]) /
+                                           static_cast<double>(data[2])
+                                     : 0.0;
+        }
+    }
+
+    // Total of the last start()..stop() phase
+    double value(Event event) const { return values_[event]; }
+
+    static const char* name(Event event) {
+        static const char* const names[kEventCount] = {
+            "cycles", "instructions", "L1d_misses", "LLC_misses",
+            "branch_misses", "dTLB_misses", "page_faults", "context_switches"};
+        return names[event];
+    }
+
+    // One line of events per operation for the last phase
+    void report(const char* phase, uint64_t operations) const {
+        double ops = operations > 0 ? static_cast<double>(operations) : 1.0;
+        std::printf("   perf/op %-10s", phase);
+        for (int i = 0; i < kEventCount; ++i) {
+            Event event = static_cast<Event>(i);
+            if (available(event)) {
+                std::printf(" | %s %.3g", name(event), values_[i] / ops);
+            } else {
+                std::printf(" | %s n/a", name(event));
+            }
+        }
+        if (available(Cycles) && available(Instructions) && values_[Cycles] > 0) {
+            std::printf(" | IPC %.2f", values_[Instructions] / values_[Cycles]);
+        }
+        std::printf("\n");
+    }
+
+    // Why hardware events are missing, for a one-time note
+    const char* unavailable_reason() const {
+        return open_errno_ != 0 ? std::strerror(open_errno_) : "";
+    }
+};
+
+}  // namespace bench
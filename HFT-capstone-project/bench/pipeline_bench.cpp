@@ -0,0 +1,105 @@
+#include "mbo_feed.h"
+#include "market_data.h"
+#include "trace.h"
+#include "bench_util.h"
+
+#include <cstring>
+#include <thread>
+#include <unistd.h>
+
+// End-to-end latency of the feed pipeline, traced per message:
+//
+//   feed thread:  receive (copy wire bytes) -> decode -> enqueue (Fifo3)
+//   book thread:  dequeue -> MboFeedHandler::on_message -> L2 publish
+//
+// Every message carries a TraceRecord stamped with the TSC at each stage;
+// the book thread hands finished records to a Tracer whose background
+// thread builds the per-hop and end-to-end histograms. Feeding is paced
+// (messages per second, 0 = as fast as possible) so the queue hop shows
+// hand-off latency rather than backlog.
+//
+//   order_book_pipeline_bench [num_messages] [rate_per_sec]
+
+struct PipelineMessage {
+    MboMessage msg;
+    TraceRecord trace;
+};
+
+int main(int argc, char* argv[]) {
+    size_t num_messages = argc > 1 ? static_cast<size_t>(std::strtoull(argv[1], nullptr, 10))
+                                   : 1000000;
+    uint64_t rate = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 500000;
+
+    std::vector<MboMessage> stream;
+    generate_mbo_stream(num_messages, 2027, stream);
+
+    // The wire: raw bytes as they would come off the socket
+    std::vector<uint8_t> wire(stream.size() * sizeof(MboMessage));
+    std::memcpy(wire.data(), stream.data(), wire.size());
+
+    std::string ring_name = "/hft_pipeline_bench_" + std::to_string(getpid());
+    MdRing ring = MdRing::create(ring_name, 1 << 16);
+    OrderBook book(BookMode::Passive);
+    MarketDataPublisher publisher(book, ring);
+    MboFeedHandler handler(book);
+    Tracer tracer;
+
+    Fifo3<PipelineMessage> queue(4096);
+    unsigned cpus = std::max(1u, std::thread::hardware_concurrency());
+
+    std::thread book_thread([&] {
+        PipelineMessage item;
+        for (size_t done = 0; done < stream.size(); ++done) {
+            while (!queue.pop(item)) {
+                if (cpus == 1) std::this_thread::yield();
+            }
+            item.trace.stamp(TraceStage::Dequeue);
+            handler.on_message(item.msg);
+            item.trace.stamp(TraceStage::BookApply);
+            publisher.publish();
+            item.trace.stamp(TraceStage::Publish);
+            tracer.submit(item.trace);
+        }
+    });
+
+    uint64_t interval_ns = rate > 0 ? 1000000000ull / rate : 0;
+    uint64_t start = bench::now_ns();
+    for (size_t i = 0; i < stream.size(); ++i) {
+        if (interval_ns > 0) {
+            uint64_t due = start + i * interval_ns;
+            while (bench::now_ns() < due) {
+                if (cpus == 1) std::this_thread::yield();
+            }
+        }
+
+        PipelineMessage item;
+        item.trace = TraceRecord{};
+        item.trace.id = i;
+        item.trace.stamp(TraceStage::Receive);
+        uint8_t packet[sizeof(MboMessage)];
+        std::memcpy(packet, wire.data() + i * sizeof(MboMessage), sizeof(packet));
+        std::memcpy(&item.msg, packet, sizeof(packet));
+        item.trace.stamp(TraceStage::Decode);
+
+        item.trace.stamp(TraceStage::Enqueue);
+        while (!queue.push(item)) {
+            if (cpus == 1) std::this_thread::yield();
+        }
+    }
+    book_thread.join();
+    uint64_t elapsed = bench::now_ns() - start;
+    tracer.flush();
+
+    std::printf("%zu messages in %.1f ms (%.2f M msgs/s, paced at %lu/s), %lu L2 messages published\n",
+                stream.size(), static_cast<double>(elapsed) / 1e6,
+                static_cast<double>(stream.size()) * 1e3 / static_cast<double>(elapsed),
+                static_cast<unsigned long>(rate),
+                static_cast<unsigned long>(publisher.messages_published()));
+    if (cpus == 1) {
+        std::printf("Note: 1 CPU available; the feed, book and aggregator threads share it, "
+                    "so the queue hop includes scheduling delay.\n");
+    }
+    std::printf("\n");
+    tracer.print();
+    return 0;
+}
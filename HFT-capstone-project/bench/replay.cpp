@@ -0,0 +1,111 @@
+#include "order_flow.h"
+#include "bench_util.h"
+#include "perf_counters.h"
+#include <cstring>
+
+// Deterministic replay driver. Records a seeded order-flow capture once
+// (or takes any capture / journal file), feeds it through a matching
+// OrderBook, and reports throughput, per-operation latency percentiles and
+// regression hashes of the final book and of the trade stream. Two engine
+// builds that print the same hashes for a capture behaved identically.
+// Hardware counters (where available) are reported per input.
+//
+//   order_book_replay [capture_file] [num_messages] [seed]
+
+struct OpStats {
+    const char* label;
+    std::vector<uint64_t> samples;
+    uint64_t rejected = 0;
+
+    explicit OpStats(const char* name) : label(name) {}
+};
+
+static void print_stats(OpStats& op) {
+    if (op.samples.empty()) return;
+    uint64_t total = 0;
+    for (uint64_t s : op.samples) total += s;
+    double mean = static_cast<double>(total) / static_cast<double>(op.samples.size());
+    uint64_t p50 = bench::percentile(op.samples, 50.0);
+    uint64_t p99 = bench::percentile(op.samples, 99.0);
+    uint64_t p999 = bench::percentile(op.samples, 99.9);
+    std::printf("%9s | %9zu | %8lu | %7.1f | %6lu | %6lu | %7lu | %8lu\n",
+                op.label, op.samples.size(), static_cast<unsigned long>(op.rejected), mean,
+                static_cast<unsigned long>(p50), static_cast<unsigned long>(p99),
+                static_cast<unsigned long>(p999), static_cast<unsigned long>(op.samples.back()));
+}
+
+int main(int argc, char* argv[]) {
+    std::string path = argc > 1 ? argv[1] : "order_flow.bin";
+    OrderFlowConfig config;
+    if (argc > 2) config.num_messages = static_cast<size_t>(std::strtoull(argv[2], nullptr, 10));
+    if (argc > 3) config.seed = static_cast<uint32_t>(std::strtoul(argv[3], nullptr, 10));
+
+    std::vector<JournalRecord> flow;
+    if (!read_order_flow_file(path, flow) || flow.empty()) {
+        std::printf("Recording %zu inputs (seed %u) to %s...\n",
+                    config.num_messages, config.seed, path.c_str());
+        generate_order_flow(config, flow);
+        if (!write_order_flow_file(path, flow)) {
+            std::fprintf(stderr, "Failed to write %s\n", path.c_str());
+            return 1;
+        }
+        flow.clear();
+        if (!read_order_flow_file(path, flow)) {
+            std::fprintf(stderr, "Failed to read back %s\n", path.c_str());
+            return 1;
+        }
+    }
+
+    OrderBook book;
+    TradeHash trades;
+    book.set_trade_handler(&TradeHash::on_trade, &trades);
+
+    OpStats adds{"add"}, cancels{"cancel"}, amends{"amend"};
+    adds.samples.reserve(flow.size());
+    cancels.samples.reserve(flow.size() / 2);
+    amends.samples.reserve(flow.size() / 4);
+
+    bench::PerfCounters perf;
+    perf.start();
+    uint64_t start = bench::now_ns();
+    for (const JournalRecord& record : flow) {
+        OpStats& op = record.op == JournalOp::Add || record.op == JournalOp::AddStop ? adds
+                    : record.op == JournalOp::Cancel                                 ? cancels
+                                                                                     : amends;
+        uint64_t t0 = bench::now_ns();
+        bool accepted = apply_order_flow(book, record);
+        op.samples.push_back(bench::now_ns() - t0);
+        if (!accepted) op.rejected++;
+    }
+    uint64_t elapsed = bench::now_ns() - start;
+    perf.stop();
+
+    double seconds = static_cast<double>(elapsed) / 1e9;
+    std::printf("Replayed %zu inputs from %s in %.1f ms: %.2f M inputs/s (%.1f ns/input incl. timing)\n\n",
+                flow.size(), path.c_str(), seconds * 1e3,
+                static_cast<double>(flow.size()) / seconds / 1e6,
+                static_cast<double>(elapsed) / static_cast<double>(flow.size()));
+    std::printf("       op |     count | rejected | mean ns | p50 ns | p99 ns | p999 ns |   max ns\n");
+    std::printf("----------+-----------+----------+---------+--------+--------+---------+---------\n");
+    print_stats(adds);
+    print_stats(cancels);
+    print_stats(amends);
+
+    std::printf("\n");
+    perf.report("input", flow.size());
+    if (!perf.hardware_available()) {
+        std::printf("   (hardware counters unavailable: %s)\n", perf.unavailable_reason());
+    }
+
+    std::printf("\nresting orders: %zu  bid levels: %zu  ask levels: %zu\n",
+                book.pool_stats().live, book.bid_levels(), book.ask_levels());
+    std::printf("trades:         %lu  (quantity %lu)\n",
+                static_cast<unsigned long>(trades.trades),
+                static_cast<unsigned long>(trades.quantity));
+    std::printf("book hash:      %016lx\n", static_cast<unsigned long>(hash_book(book)));
+    std::printf("trade hash:     %016lx\n", static_cast<unsigned long>(trades.value));
+
+    std::printf("\n");
+    book.print_latency_stats();
+    return 0;
+}
@@ -0,0 +1,93 @@
+#include "order_book.h"
+#include "bench_util.h"
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+// Snapshot benchmark: builds a book of resting orders, then reports
+//   - synchronous save time and file size
+//   - how long fork() stalls the book thread for a copy-on-write save,
+//     and how long the child takes to finish writing
+//   - bulk restore time (target: 10M orders in under one second)
+//
+//   order_book_snapshot_bench [snapshot_dir] [num_orders]
+
+static void build(OrderBook& book, size_t num_orders) {
+    for (size_t i = 0; i < num_orders; ++i) {
+        // 1000 bid levels below 100.00 and 1000 ask levels above it: never crosses
+        bool is_buy = (i & 1) == 0;
+        double offset = static_cast<double>(1 + (i >> 1) % 1000) * 0.01;
+        double price = is_buy ? 100.0 - offset : 100.0 + offset;
+        book.add_order(Order(i + 1, is_buy, price, 100 + i % 7, i));
+    }
+}
+
+int main(int argc, char** argv) {
+    std::string dir = argc > 1 ? argv[1] : ".";
+    size_t num_orders = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 10000000;
+    std::string path = dir + "/order_book_snapshot_bench.snap";
+    std::string async_path = dir + "/order_book_snapshot_bench_async.snap";
+
+    auto book = std::make_unique<OrderBook>(BookMode::Passive);
+    uint64_t t0 = bench::now_ns();
+    build(*book, num_orders);
+    uint64_t build_ns = bench::now_ns() - t0;
+
+    t0 = bench::now_ns();
+    bool saved = book->save_snapshot(path, 42);
+    uint64_t save_ns = bench::now_ns() - t0;
+
+    t0 = bench::now_ns();
+    pid_t child = book->save_snapshot_async(async_path, 43);
+    uint64_t fork_ns = bench::now_ns() - t0;
+    bool async_saved = OrderBook::wait_snapshot(child);
+    uint64_t async_ns = bench::now_ns() - t0;
+
+    FILE* f = std::fopen(path.c_str(), "rb");
+    long file_bytes = 0;
+    if (f) {
+        std::fseek(f, 0, SEEK_END);
+        file_bytes = std::ftell(f);
+        std::fclose(f);
+    }
+
+    // Restore into a fresh book each run (best of 3: page-fault cost is noisy)
+    uint64_t load_ns = UINT64_MAX;
+    bool match = true;
+    for (int run = 0; run < 3; ++run) {
+        OrderBook restored(BookMode::Passive);
+        uint64_t sequence = 0;
+        t0 = bench::now_ns();
+        bool loaded = restored.load_snapshot(path, &sequence);
+        load_ns = std::min(load_ns, bench::now_ns() - t0);
+
+        match = match && loaded && sequence == 42 &&
+                restored.bid_levels() == book->bid_levels() &&
+                restored.ask_levels() == book->ask_levels() &&
+                restored.pool_stats().live == book->pool_stats().live &&
+                restored.best_bid().price == book->best_bid().price &&
+                restored.best_bid().quantity == book->best_bid().quantity &&
+                restored.best_ask().price == book->best_ask().price &&
+                restored.best_ask().quantity == book->best_ask().quantity;
+    }
+
+    std::printf("orders:            %zu\n", num_orders);
+    std::printf("build (add_order): %8.1f ms\n", static_cast<double>(build_ns) / 1e6);
+    std::printf("snapshot file:     %8.1f MB (%.1f B/order)\n",
+                static_cast<double>(file_bytes) / 1e6,
+                static_cast<double>(file_bytes) / static_cast<double>(num_orders));
+    std::printf("save (sync):       %8.1f ms %s\n", static_cast<double>(save_ns) / 1e6,
+                saved ? "" : "FAILED");
+    std::printf("save (fork) stall: %8.3f ms, child done after %.1f ms %s\n",
+                static_cast<double>(fork_ns) / 1e6, static_cast<double>(async_ns) / 1e6,
+                async_saved ? "" : "FAILED");
+    std::printf("restore:           %8.1f ms (%.1f ns/order) %s\n",
+                static_cast<double>(load_ns) / 1e6,
+                static_cast<double>(load_ns) / static_cast<double>(num_orders),
+                match ? "" : "MISMATCH");
+
+    std::remove(path.c_str());
+    std::remove(async_path.c_str());
+    return match && saved && async_saved ? 0 : 1;
+}
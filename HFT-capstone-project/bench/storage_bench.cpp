@@ -0,0 +1,78 @@
+#include "order_book.h"
+#include "bench_util.h"
+#include <random>
+#include <sys/wait.h>
+
+// Resting-order storage benchmark: builds books of 1M, 5M and 10M passive
+// orders and reports resident memory per order and cancel latency.
+// Each size runs in a forked child so RSS is measured from a clean heap.
+
+static void run_size(size_t num_orders) {
+    size_t rss_before = bench::resident_bytes();
+
+    OrderBook book;
+    uint64_t build_start = bench::now_ns();
+    for (size_t i = 0; i < num_orders; ++i) {
+        // 1000 bid levels below 100.00 and 1000 ask levels above it: never crosses
+        bool is_buy = (i & 1) == 0;
+        double offset = static_cast<double>(1 + (i >> 1) % 1000) * 0.01;
+        double price = is_buy ? 100.0 - offset : 100.0 + offset;
+        book.add_order(Order(i + 1, is_buy, price, 100, 0));
+    }
+    uint64_t build_ns = bench::now_ns() - build_start;
+    size_t rss_after = bench::resident_bytes();
+
+    // Cancel a fixed, shuffled sample of resting orders
+    const size_t num_cancels = 100000;
+    std::mt19937_64 gen(42);
+    std::uniform_int_distribution<uint64_t> id_dist(1, num_orders);
+    std::vector<uint64_t> ids(num_cancels);
+    for (auto& id : ids) id = id_dist(gen);
+
+    std::vector<uint64_t> samples;
+    samples.reserve(num_cancels);
+    size_t cancelled = 0;
+    uint64_t cancel_start = bench::now_ns();
+    for (uint64_t id : ids) {
+        uint64_t t0 = bench::now_ns();
+        if (book.cancel_order(id)) cancelled++;
+        samples.push_back(bench::now_ns() - t0);
+    }
+    uint64_t cancel_ns = bench::now_ns() - cancel_start;
+
+    double rss_mb = static_cast<double>(rss_after - rss_before) / (1024.0 * 1024.0);
+    std::printf("%10zu | %9.1f | %8.1f | %9.1f | %9.1f | %6lu | %6lu\n",
+                num_orders,
+                rss_mb,
+                static_cast<double>(rss_after - rss_before) / static_cast<double>(num_orders),
+                static_cast<double>(build_ns) / static_cast<double>(num_orders),
+                static_cast<double>(cancel_ns) / static_cast<double>(num_cancels),
+                static_cast<unsigned long>(bench::percentile(samples, 50.0)),
+                static_cast<unsigned long>(bench::percentile(samples, 99.0)));
+    (void)cancelled;
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<size_t> sizes = {1000000, 5000000, 10000000};
+    if (argc > 1) {
+        sizes.clear();
+        for (int i = 1; i < argc; ++i) {
+            sizes.push_back(static_cast<size_t>(std::strtoull(argv[i], nullptr, 10)));
+        }
+    }
+
+    std::printf("    orders |  RSS (MB) | B/order | add ns/op | cxl ns/op | cxl p50 | cxl p99\n");
+    std::printf("-----------+-----------+---------+-----------+-----------+--------+-------\n");
+    std::fflush(stdout);
+    for (size_t n : sizes) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            run_size(n);
+            std::fflush(stdout);
+            _exit(0);
+        }
+        int status = 0;
+        waitpid(pid, &status, 0);
+    }
+    return 0;
+}
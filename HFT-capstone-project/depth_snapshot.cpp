@@ -0,0 +1,34 @@
+#include "depth_snapshot.h"
+
+// ============================================================================
+// Constructor
+// ============================================================================
+DepthSnapshot::DepthSnapshot(OrderBook& book, size_t depth)
+    : depth_(depth)
+    , version_(0)
+    , valid_(false) {
+    bids_.reserve(depth);
+    asks_.reserve(depth);
+    book.set_level_tracking(true);
+}
+
+// ============================================================================
+// Refresh (lazy full top-N view)
+// ============================================================================
+bool DepthSnapshot::refresh(const OrderBook& book) {
+    if (valid_ && book.level_version() == version_) {
+        return false;  // Nothing changed since the last publish
+    }
+
+    book.get_snapshot(depth_, bids_, asks_);
+    version_ = book.level_version();
+    valid_ = true;
+    return true;
+}
+
+// ============================================================================
+// Collect Deltas
+// ============================================================================
+size_t DepthSnapshot::collect_deltas(OrderBook& book, std::vector<LevelUpdate>& deltas) {
+    return book.drain_level_changes(deltas);
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "order_book.h"
+
+// ============================================================================
+// Depth Snapshot
+// ============================================================================
+// Cached top-N view of an OrderBook. refresh() only re-walks the book when
+// its level_version() moved since the last refresh, so polling an unchanged
+// book costs one integer compare. Deltas for a market data publisher come
+// from the book's dirty-level queue (enabled on construction).
+class DepthSnapshot {
+private:
+    size_t depth_;
+    uint64_t version_;
+    bool valid_;
+    std::vector<PriceLevel> bids_;
+    std::vector<PriceLevel> asks_;
+
+public:
+    DepthSnapshot(OrderBook& book, size_t depth);
+
+    // Recompute the top-N view if the book changed; returns true if it did
+    bool refresh(const OrderBook& book);
+
+    // Level changes since the last call, full depth, one entry per level
+    size_t collect_deltas(OrderBook& book, std::vector<LevelUpdate>& deltas);
+
+    const std::vector<PriceLevel>& bids() const { return bids_; }
+    const std::vector<PriceLevel>& asks() const { return asks_; }
+    size_t depth() const { return depth_; }
+    uint64_t version() const { return version_; }
+};
@@ -0,0 +1,417 @@
+#include "journal.h"
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+uint64_t steady_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+bool write_all(int fd, const void* data, size_t size) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    while (size > 0) {
+        ssize_t n = ::write(fd, p, size);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        p += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// The record replay() accepts after `expected_seq - 1`
+bool is_next(const JournalRecord& record, uint64_t expected_seq) {
+    return record.seq == expected_seq && record.checksum == Journal::checksum(record);
+}
+
+}  // namespace
+
+// ============================================================================
+// Constructor & Destructor
+// ============================================================================
+Journal::Journal(const std::string& path, const JournalConfig& config)
+    : config_(config)
+    , fd_(::open(path.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644))
+    , queue_(config.queue_capacity)
+    , running_(true)
+    , durable_seq_(0)
+    , failed_(false)
+    , next_seq_(1) {
+    if (fd_ < 0) {
+        throw std::runtime_error("Journal: cannot open " + path + ": " + std::strerror(errno));
+    }
+
+    // A new file (or one torn before its header was complete) gets the
+    // header; an existing one must carry a header this build can read
+    auto fail = [&](const char* what) {
+        int error = errno;
+        ::close(fd_);
+        throw std::runtime_error(std::string("Journal: cannot ") + what + " " + path + ": " +
+                                 std::strerror(error));
+    };
+    constexpr off_t kRecordsStart = sizeof(JournalFileHeader);
+    JournalFileHeader header{};
+    ssize_t header_read = ::pread(fd_, &header, sizeof(header), 0);
+    if (header_read < 0) {
+        fail("read");
+    }
+    if (header_read < kRecordsStart) {
+        header = file_header();
+        if (::ftruncate(fd_, 0) != 0 || !write_all(fd_, &header, sizeof(header))) {
+            fail("write the header of");
+        }
+    } else if (!valid_header(header)) {
+        ::close(fd_);
+        throw std::runtime_error("Journal: " + path + " is not a journal of version 1 to " +
+                                 std::to_string(kJournalVersion));
+    } else if (header.version < kJournalVersion) {
+        // New records may use fields the old version lacked: relabel the
+        // file. fd_ is O_APPEND, where pwrite ignores the offset on Linux.
+        header.version = kJournalVersion;
+        int header_fd = ::open(path.c_str(), O_WRONLY);
+        bool relabelled = header_fd >= 0 &&
+            ::pwrite(header_fd, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header));
+        if (header_fd >= 0) {
+            ::close(header_fd);
+        }
+        if (!relabelled) {
+            fail("write the header of");
+        }
+    }
+
+    // Continue the sequence of an existing journal. A crash can leave a
+    // torn or corrupt tail; it is cut back to the last record replay()
+    // accepts, so new records stay aligned and replayable behind it.
+    uint64_t last_seq = 0;
+    std::vector<JournalRecord> chunk(4096);
+    for (;;) {
+        ssize_t n = ::pread(fd_, chunk.data(), chunk.size() * sizeof(JournalRecord),
+                            kRecordsStart + static_cast<off_t>(last_seq * sizeof(JournalRecord)));
+        size_t count = n > 0 ? static_cast<size_t>(n) / sizeof(JournalRecord) : 0;
+        size_t valid = 0;
+        while (valid < count && is_next(chunk[valid], last_seq + 1)) {
+            last_seq = chunk[valid++].seq;
+        }
+        if (valid < chunk.size()) {
+            break;
+        }
+    }
+    if (::ftruncate(fd_, kRecordsStart + static_cast<off_t>(last_seq * sizeof(JournalRecord))) != 0) {
+        fail("truncate");
+    }
+    next_seq_ = last_seq + 1;
+    durable_seq_.store(last_seq, std::memory_order_release);
+
+    writer_ = std::thread(&Journal::writer_loop, this);
+}
+
+Journal::~Journal() {
+    running_.store(false, std::memory_order_release);
+    writer_.join();
+    ::close(fd_);
+}
+
+// ============================================================================
+// Record (book thread)
+// ============================================================================
+uint64_t Journal::append(JournalRecord& record) {
+    if (failed()) {
+        return 0;
+    }
+    record.seq = next_seq_++;
+    record.checksum = checksum(record);
+
+    // Back-pressure only if the writer is a full ring behind
+    while (!queue_.push(record)) {
+        std::this_thread::yield();
+    }
+    return record.seq;
+}
+
+uint64_t Journal::record_add(const Order& order) {
+    JournalRecord record{};
+    record.op = JournalOp::Add;
+    record.order_id = order.order_id;
+    record.is_buy = order.is_buy ? 1 : 0;
+    record.order_type = order.type;
+    record.tif = order.tif;
+    record.price = order.price;
+    record.quantity = order.quantity;
+    record.timestamp_ns = order.timestamp_ns;
+    record.display_quantity = order.display_quantity;
+    record.expire_ns = order.expire_ns;
+    record.participant_id = order.participant_id;
+    record.stp = order.stp;
+    return append(record);
+}
+
+uint64_t Journal::record_add_stop(const Order& order, double trigger_price) {
+    JournalRecord record{};
+    record.op = JournalOp::AddStop;
+    record.order_id = order.order_id;
+    record.is_buy = order.is_buy ? 1 : 0;
+    record.order_type = order.type;
+    record.tif = order.tif;
+    record.price = order.price;
+    record.quantity = order.quantity;
+    record.timestamp_ns = order.timestamp_ns;
+    record.display_quantity = order.display_quantity;
+    record.trigger_price = trigger_price;
+    record.expire_ns = order.expire_ns;
+    record.participant_id = order.participant_id;
+    record.stp = order.stp;
+    return append(record);
+}
+
+uint64_t Journal::record_cancel(uint64_t order_id) {
+    JournalRecord record{};
+    record.op = JournalOp::Cancel;
+    record.order_id = order_id;
+    return append(record);
+}
+
+uint64_t Journal::record_amend(uint64_t order_id, double new_price, uint64_t new_quantity) {
+    JournalRecord record{};
+    record.op = JournalOp::Amend;
+    record.order_id = order_id;
+    record.price = new_price;
+    record.quantity = new_quantity;
+    return append(record);
+}
+
+uint64_t Journal::record_clock(uint64_t now_ns) {
+    JournalRecord record{};
+    record.op = JournalOp::Clock;
+    record.timestamp_ns = now_ns;
+    return append(record);
+}
+
+uint64_t Journal::record_auction_start() {
+    JournalRecord record{};
+    record.op = JournalOp::AuctionStart;
+    return append(record);
+}
+
+uint64_t Journal::record_uncross(double reference_price) {
+    JournalRecord record{};
+    record.op = JournalOp::Uncross;
+    record.price = reference_price;
+    return append(record);
+}
+
+bool Journal::wait_durable(uint64_t seq) const {
+    while (durable_seq() < seq) {
+        if (failed()) {
+            return false;
+        }
+        std::this_thread::yield();
+    }
+    return true;
+}
+
+// ============================================================================
+// Writer Thread
+// ============================================================================
+void Journal::writer_loop() {
+    const bool per_message = config_.policy == DurabilityPolicy::PerMessage;
+    const bool group_commit = config_.policy == DurabilityPolicy::GroupCommit;
+    const size_t batch_limit = per_message ? 1 : std::max<size_t>(config_.group_size, 64);
+    const uint64_t group_interval_ns = config_.group_interval_us * 1000;
+
+    std::vector<JournalRecord> batch;
+    batch.reserve(batch_limit);
+    uint64_t last_written = durable_seq();
+    size_t unsynced = 0;
+    uint64_t first_unsynced_ns = 0;
+    uint32_t idle_spins = 0;
+
+    // Any failure latches: durable_seq_ stays at the last record known to
+    // be on disk, and later records are drained from the ring and dropped
+    auto fail = [&]() {
+        failed_.store(true, std::memory_order_release);
+    };
+    auto sync = [&]() {
+        if (failed()) {
+            return;
+        }
+        if (::fdatasync(fd_) != 0) {
+            fail();
+            return;
+        }
+        unsynced = 0;
+        durable_seq_.store(last_written, std::memory_order_release);
+    };
+
+    for (;;) {
+        JournalRecord record;
+        while (batch.size() < batch_limit && queue_.pop(record)) {
+            batch.push_back(record);
+        }
+
+        if (!batch.empty()) {
+            if (failed() || !write_all(fd_, batch.data(), batch.size() * sizeof(JournalRecord))) {
+                fail();
+                batch.clear();
+                continue;
+            }
+            last_written = batch.back().seq;
+            if (unsynced == 0) {
+                first_unsynced_ns = steady_ns();
+            }
+            unsynced += batch.size();
+            batch.clear();
+            idle_spins = 0;
+
+            if (per_message || (group_commit && unsynced >= config_.group_size)) {
+                sync();
+            } else if (!group_commit) {
+                durable_seq_.store(last_written, std::memory_order_release);
+            }
+            continue;
+        }
+
+        if (group_commit && unsynced > 0 &&
+            steady_ns() - first_unsynced_ns >= group_interval_ns) {
+            sync();
+        }
+        if (!running_.load(std::memory_order_acquire) && queue_.empty()) {
+            break;
+        }
+
+        // Idle: yield first, then sleep so the writer does not steal the
+        // book thread's core
+        if (++idle_spins < 64) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+
+    sync();
+}
+
+// ============================================================================
+// Replay (recovery)
+// ============================================================================
+size_t Journal::replay(const std::string& path, OrderBook& book, uint64_t after_seq) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return 0;
+    }
+    JournalFileHeader header{};
+    if (::read(fd, &header, sizeof(header)) != static_cast<ssize_t>(sizeof(header)) ||
+        !valid_header(header)) {
+        ::close(fd);
+        return 0;
+    }
+
+    std::vector<JournalRecord> chunk(4096);
+    uint64_t expected_seq = 1;
+    size_t applied = 0;
+    bool done = false;
+
+    while (!done) {
+        ssize_t n = ::read(fd, chunk.data(), chunk.size() * sizeof(JournalRecord));
+        if (n <= 0) {
+            break;
+        }
+        size_t count = static_cast<size_t>(n) / sizeof(JournalRecord);
+        if (count == 0) {
+            break;  // Torn partial record at the tail
+        }
+        if (static_cast<size_t>(n) % sizeof(JournalRecord) != 0) {
+            // Rewind over the partial record so the next read realigns
+            ::lseek(fd, -static_cast<off_t>(static_cast<size_t>(n) % sizeof(JournalRecord)), SEEK_CUR);
+        }
+
+        for (size_t i = 0; i < count; ++i) {
+            const JournalRecord& record = chunk[i];
+            if (!is_next(record, expected_seq)) {
+                done = true;
+                break;
+            }
+            if (record.seq <= after_seq) {
+                expected_seq++;
+                continue;
+            }
+            switch (record.op) {
+                case JournalOp::Add:
+                {
+                    Order order(record.order_id, record.is_buy != 0, record.price,
+                                record.quantity, record.timestamp_ns,
+                                record.order_type, record.tif);
+                    order.display_quantity = record.display_quantity;
+                    order.expire_ns = record.expire_ns;
+                    order.participant_id = record.participant_id;
+                    order.stp = record.stp;
+                    book.add_order(order);
+                    break;
+                }
+                case JournalOp::AddStop:
+                {
+                    Order order(record.order_id, record.is_buy != 0, record.price,
+                                record.quantity, record.timestamp_ns,
+                                record.order_type, record.tif);
+                    order.display_quantity = record.display_quantity;
+                    order.expire_ns = record.expire_ns;
+                    order.participant_id = record.participant_id;
+                    order.stp = record.stp;
+                    book.add_stop_order(order, record.trigger_price);
+                    break;
+                }
+                case JournalOp::Cancel:
+                    book.cancel_order(record.order_id);
+                    break;
+                case JournalOp::Amend:
+                    book.amend_order(record.order_id, record.price, record.quantity);
+                    break;
+                case JournalOp::Clock:
+                    book.advance_time(record.timestamp_ns);
+                    break;
+                case JournalOp::AuctionStart:
+                    book.begin_auction();
+                    break;
+                case JournalOp::Uncross:
+                    book.uncross(record.price);
+                    break;
+            }
+            expected_seq++;
+            applied++;
+        }
+    }
+
+    ::close(fd);
+    return applied;
+}
+
+JournalFileHeader Journal::file_header() {
+    JournalFileHeader header{};
+    header.magic = kJournalMagic;
+    header.version = kJournalVersion;
+    header.record_size = sizeof(JournalRecord);
+    return header;
+}
+
+bool Journal::valid_header(const JournalFileHeader& header) {
+    return header.magic == kJournalMagic && header.version >= 1 &&
+           header.version <= kJournalVersion && header.record_size == sizeof(JournalRecord);
+}
+
+// FNV-1a over everything but the checksum field
+uint32_t Journal::checksum(const JournalRecord& record) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&record);
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < offsetof(JournalRecord, checksum); ++i) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+#include "order_book.h"
+#include "spsc_q3.h"
+#include <atomic>
+#include <string>
+#include <thread>
+
+// ============================================================================
+// Journal Record (128 bytes, fixed size)
+// ============================================================================
+// The size is fixed once, with reserved space: a new field takes reserved
+// bytes (zero in older files) and bumps kJournalVersion, so the record
+// layout never shifts under an existing file.
+enum class JournalOp : uint8_t {
+    Add = 1,
+    Cancel = 2,
+    Amend = 3,
+    AddStop = 4,   // Pending stop; cancelled through Cancel
+    Clock = 5,     // Engine clock advance (timestamp_ns), expires GTT orders
+    AuctionStart = 6,  // Call phase begins
+    Uncross = 7        // Call phase ends (price: reference price, NaN if none)
+};
+
+struct JournalRecord {
+    uint64_t seq;           // Starts at 1, no gaps
+    uint64_t order_id;
+    double price;           // Add / Amend / Uncross
+    uint64_t quantity;      // Add / Amend
+    uint64_t timestamp_ns;  // Add / Clock
+    uint64_t display_quantity;  // Add: iceberg slice size, 0 = fully displayed
+    double trigger_price;   // AddStop
+    uint64_t expire_ns;     // Add / AddStop: TimeInForce::Gtt
+    JournalOp op;
+    uint8_t is_buy;         // Add
+    OrderType order_type;   // Add (0 = Limit)
+    TimeInForce tif;        // Add (0 = GTC)
+    uint32_t participant_id;  // Add / AddStop (0 = anonymous)
+    StpMode stp;            // Add / AddStop
+    uint8_t reserved[51];   // Zero
+    uint32_t checksum;      // Over the preceding 124 bytes; detects a torn tail
+};
+static_assert(sizeof(JournalRecord) == 128, "JournalRecord must stay 128 bytes");
+
+// ============================================================================
+// Journal File Header
+// ============================================================================
+// Journals and order-flow captures start with this header, then records
+// back to back. Any version from 1 to kJournalVersion is read (older
+// records hold zeros where newer fields live); a file without the header
+// (e.g. from a build before it existed), of a newer version or of another
+// record size is rejected, not misread.
+constexpr uint64_t kJournalMagic = 0x4C4E524A54544648ull;  // "HFTTJRNL"
+constexpr uint32_t kJournalVersion = 1;
+
+struct JournalFileHeader {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t record_size;  // sizeof(JournalRecord)
+    uint8_t reserved[48];  // Zero
+};
+static_assert(sizeof(JournalFileHeader) == 64, "JournalFileHeader must stay 64 bytes");
+
+// ============================================================================
+// Durability Policy
+// ============================================================================
+// PerMessage:  fdatasync after every record
+// GroupCommit: fdatasync once group_size records or group_interval_us elapsed
+// Async:       write only; the OS flushes (fdatasync on close)
+// In every mode the sync happens on the writer thread; the book thread only
+// pushes onto the SPSC ring and never waits for the disk.
+enum class DurabilityPolicy : uint8_t {
+    PerMessage,
+    GroupCommit,
+    Async
+};
+
+struct JournalConfig {
+    DurabilityPolicy policy = DurabilityPolicy::GroupCommit;
+    size_t group_size = 256;
+    uint64_t group_interval_us = 1000;
+    size_t queue_capacity = 1 << 16;
+};
+
+// ============================================================================
+// Journal (write-ahead log of accepted book inputs)
+// ============================================================================
+// Call record_*() for every add, and for every cancel/amend the book
+// accepted. Records are queued to a dedicated writer thread through a
+// Fifo3 SPSC ring; durable_seq() reports what has reached the disk under the
+// configured policy. A failed write or sync latches failed(): durable_seq()
+// stops where it was, and nothing more is accepted or written. replay()
+// rebuilds a book from a journal file.
+class Journal {
+private:
+    JournalConfig config_;
+    int fd_;
+    Fifo3<JournalRecord> queue_;
+    std::thread writer_;
+    std::atomic<bool> running_;
+    std::atomic<uint64_t> durable_seq_;
+    std::atomic<bool> failed_;
+    uint64_t next_seq_;
+
+    uint64_t append(JournalRecord& record);
+    void writer_loop();
+
+public:
+    // Opens (appending) or creates the journal file. A torn or corrupt
+    // tail is truncated back to the last valid record, and the sequence
+    // continues from that record. Throws std::runtime_error if the file
+    // cannot be opened, truncated or given its header, or has a header
+    // this build cannot read.
+    Journal(const std::string& path, const JournalConfig& config = JournalConfig());
+    ~Journal();
+
+    Journal(const Journal&) = delete;
+    Journal& operator=(const Journal&) = delete;
+
+    // Book thread: returns the record's sequence number, or 0 once the
+    // journal has failed (the record is dropped)
+    uint64_t record_add(const Order& order);
+    uint64_t record_add_stop(const Order& order, double trigger_price);
+    uint64_t record_cancel(uint64_t order_id);
+    uint64_t record_amend(uint64_t order_id, double new_price, uint64_t new_quantity);
+    uint64_t record_clock(uint64_t now_ns);
+    uint64_t record_auction_start();
+    uint64_t record_uncross(double reference_price);
+
+    // Highest sequence durable under the configured policy
+    uint64_t durable_seq() const { return durable_seq_.load(std::memory_order_acquire); }
+    uint64_t last_seq() const { return next_seq_ - 1; }
+
+    // A write or fdatasync failed (ENOSPC, EIO, ...): records after
+    // durable_seq() never reached the disk
+    bool failed() const { return failed_.load(std::memory_order_acquire); }
+
+    // Wait until `seq` is durable (for callers that must ack only after
+    // sync). Returns false if the journal failed first.
+    bool wait_durable(uint64_t seq) const;
+
+    // Rebuild `book` by replaying `path`. Applies nothing if the file
+    // header is missing or unsupported, and stops at the first torn or
+    // corrupt record. Records up to `after_seq` are verified but skipped, so a book
+    // restored from a snapshot taken at that sequence only replays the tail.
+    // Returns the number of records applied.
+    static size_t replay(const std::string& path, OrderBook& book, uint64_t after_seq = 0);
+
+    static uint32_t checksum(const JournalRecord& record);
+
+    // Header of a file this build writes, and whether one can be read
+    static JournalFileHeader file_header();
+    static bool valid_header(const JournalFileHeader& header);
+};
@@ -0,0 +1,230 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// ============================================================================
+// Timestamp Counter
+// ============================================================================
+// rdtsc at the start of a measurement and rdtscp at the end (waits for the
+// measured instructions to retire). Ticks are converted to ns only when
+// reporting, using a ratio calibrated once against steady_clock. Other
+// architectures fall back to steady_clock ns with a ratio of 1.
+namespace tsc {
+
+inline uint64_t start() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+inline uint64_t stop() {
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned int aux;
+    return __rdtscp(&aux);
+#else
+    return start();
+#endif
+}
+
+// ns per tick, measured over ~10 ms on first use
+inline double ns_per_tick() {
+    static const double ratio = [] {
+#if defined(__x86_64__) || defined(__i386__)
+        auto wall_start = std::chrono::steady_clock::now();
+        uint64_t tick_start = start();
+        while (std::chrono::steady_clock::now() - wall_start < std::chrono::milliseconds(10)) {
+        }
+        uint64_t ticks = stop() - tick_start;
+        auto wall_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - wall_start).count();
+        return ticks > 0 ? static_cast<double>(wall_ns) / static_cast<double>(ticks) : 1.0;
+#else
+        return 1.0;
+#endif
+    }();
+    return ratio;
+}
+
+}  // namespace tsc
+
+// ============================================================================
+// Latency Histogram (HDR-style, log-linear)
+// ============================================================================
+// Values below 2^kSubBucketBits are counted exactly; above that each power
+// of two is split into 2^(kSubBucketBits-1) linear buckets, so the relative
+// error stays under 1/2^(kSubBucketBits-1) (~3%) for any 64-bit value.
+// Fixed memory (~15 KB), no allocation, recording is a handful of
+// instructions. Keep one histogram per thread and merge() for reporting.
+class LatencyHistogram {
+public:
+    static constexpr uint32_t kSubBucketBits = 6;
+    static constexpr uint64_t kSubBucketHalf = uint64_t{1} << (kSubBucketBits - 1);
+    static constexpr size_t kBucketCount = (64 - kSubBucketBits + 2) * kSubBucketHalf;
+
+private:
+    std::array<uint64_t, kBucketCount> counts_{};
+    uint64_t total_count_ = 0;
+    uint64_t max_ = 0;
+
+    static size_t index_of(uint64_t value) {
+        if (value < (uint64_t{1} << kSubBucketBits)) {
+            return static_cast<size_t>(value);
+        }
+        uint32_t msb = 63u - static_cast<uint32_t>(__builtin_clzll(value));
+        uint32_t shift = msb - kSubBucketBits + 1;
+        return static_cast<size_t>(shift * kSubBucketHalf + (value >> shift));
+    }
+
+    // Highest value that maps to bucket `index`
+    static uint64_t upper_bound_of(size_t index) {
+        if (index < (size_t{1} << kSubBucketBits)) {
+            return index;
+        }
+        uint64_t shift = index / kSubBucketHalf - 1;
+        uint64_t sub = index - shift * kSubBucketHalf;
+        return ((sub + 1) << shift) - 1;
+    }
+
+public:
+    void record(uint64_t value) {
+        counts_[index_of(value)]++;
+        total_count_++;
+        max_ = std::max(max_, value);
+    }
+
+    void merge(const LatencyHistogram& other) {
+        for (size_t i = 0; i < kBucketCount; ++i) {
+            counts_[i] += other.counts_[i];
+        }
+        total_count_ += other.total_count_;
+        max_ = std::max(max_, other.max_);
+    }
+
+    void reset() {
+        counts_.fill(0);
+        total_count_ = 0;
+        max_ = 0;
+    }
+
+    uint64_t count() const { return total_count_; }
+    uint64_t max() const { return max_; }
+
+    // Smallest recorded value v such that pct% of samples are <= v (within
+    // bucket precision)
+    uint64_t percentile(double pct) const {
+        if (total_count_ == 0) return 0;
+        uint64_t rank = static_cast<uint64_t>(pct / 100.0 * static_cast<double>(total_count_) + 0.5);
+        rank = std::max<uint64_t>(rank, 1);
+        uint64_t seen = 0;
+        for (size_t i = 0; i < kBucketCount; ++i) {
+            seen += counts_[i];
+            if (seen >= rank) {
+                return std::min(upper_bound_of(i), max_);
+            }
+        }
+        return max_;
+    }
+
+    // One report line; `scale` converts recorded units to ns
+    void print(const char* label, double scale = 1.0) const {
+        auto ns = [scale](uint64_t v) { return static_cast<double>(v) * scale; };
+        std::printf("   %-20s %10lu | p50 %7.0f | p90 %7.0f | p99 %7.0f | p99.9 %8.0f | max %9.0f ns\n",
+                    label, static_cast<unsigned long>(total_count_),
+                    ns(percentile(50.0)), ns(percentile(90.0)), ns(percentile(99.0)),
+                    ns(percentile(99.9)), ns(max_));
+    }
+};
+
+// ============================================================================
+// Per-operation OrderBook latency (HFT_LATENCY_STATS builds only)
+// ============================================================================
+// Recorded in TSC ticks. An operation that calls another public operation
+// (an amend that moves price is a cancel plus an add) is recorded once, as
+// the outer operation.
+struct OrderBookLatency {
+    LatencyHistogram add_passive;
+    LatencyHistogram add_crossing;
+    LatencyHistogram add_rejected;
+    LatencyHistogram cancel;
+    LatencyHistogram amend;
+    LatencyHistogram snapshot;
+    bool in_operation = false;
+
+    void merge(const OrderBookLatency& other) {
+        add_passive.merge(other.add_passive);
+        add_crossing.merge(other.add_crossing);
+        add_rejected.merge(other.add_rejected);
+        cancel.merge(other.cancel);
+        amend.merge(other.amend);
+        snapshot.merge(other.snapshot);
+    }
+
+    void reset() {
+        add_passive.reset();
+        add_crossing.reset();
+        add_rejected.reset();
+        cancel.reset();
+        amend.reset();
+        snapshot.reset();
+    }
+
+    void print() const {
+        double scale = tsc::ns_per_tick();
+        add_passive.print("add (passive)", scale);
+        add_crossing.print("add (crossing)", scale);
+        add_rejected.print("add (rejected)", scale);
+        cancel.print("cancel", scale);
+        amend.print("amend", scale);
+        snapshot.print("get_snapshot", scale);
+    }
+};
+
+// Times the enclosing scope into one OrderBookLatency histogram; nested
+// scopes inside an already-timed operation record nothing
+class LatencyScope {
+private:
+    OrderBookLatency& stats_;
+    LatencyHistogram* target_;
+    uint64_t start_;
+
+public:
+    LatencyScope(OrderBookLatency& stats, LatencyHistogram OrderBookLatency::*target)
+        : stats_(stats)
+        , target_(stats.in_operation ? nullptr : &(stats.*target))
+        , start_(tsc::start()) {
+        stats_.in_operation = true;
+    }
+
+    ~LatencyScope() {
+        if (target_) {
+            target_->record(tsc::stop() - start_);
+            stats_.in_operation = false;
+        }
+    }
+
+    // Pick a different histogram once the operation knows its path
+    void retarget(LatencyHistogram OrderBookLatency::*target) {
+        if (target_) target_ = &(stats_.*target);
+    }
+
+    LatencyScope(const LatencyScope&) = delete;
+    LatencyScope& operator=(const LatencyScope&) = delete;
+};
+
+#ifdef HFT_LATENCY_STATS
+#define HFT_LATENCY_SCOPE(scope, hist) LatencyScope scope(latency_, &OrderBookLatency::hist)
+#define HFT_LATENCY_RETARGET(scope, hist) scope.retarget(&OrderBookLatency::hist)
+#else
+#define HFT_LATENCY_SCOPE(scope, hist) ((void)0)
+#define HFT_LATENCY_RETARGET(scope, hist) ((void)0)
+#endif
@@ -1,8 +1,16 @@
 #include "order_book.h"
+#include "depth_snapshot.h"
+#include "market_data.h"
+#include "mbo_feed.h"
+#include "journal.h"
 #include <iostream>
 #include <chrono> // using it to get precise timestamps
+#include <cstddef>
+#include <cstdio>
 #include <random> // using it for random numbrs
+#include <stdexcept>
 #include <vector>
+#include <unistd.h>
 
 // Helper function to get current timestamp in nanoseconds
 uint64_t get_timestamp_ns() {
@@ -120,8 +128,8 @@ void test_performance() {
     OrderBook book;
     const size_t num_orders = 100000;
     
-    std::random_device rd;
-    std::mt19937 gen(rd());
+    // Fixed seed so every run sees the same flow and timings are comparable
+    std::mt19937 gen(42);
     std::uniform_int_distribution<> side_dist(0, 1);
     std::uniform_real_distribution<> price_dist(95.0, 105.0);
     std::uniform_int_distribution<uint64_t> qty_dist(10, 1000);
@@ -167,6 +175,60 @@ void test_performance() {
     std::cout << "   Average: " << (duration.count() / 10000.0) 
               << " μs per snapshot\n\n";
 
+    // Same polling through the cached snapshot: only the first call walks the book
+    DepthSnapshot depth_snapshot(book, 10);
+    size_t recomputed = 0;
+
+    auto snap_start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < 10000; ++i) {
+        if (depth_snapshot.refresh(book)) recomputed++;
+    }
+    auto snap_end = std::chrono::high_resolution_clock::now();
+    auto snap_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(snap_end - snap_start);
+
+    std::cout << " Refreshed cached snapshot 10,000 times in "
+              << snap_ns.count() / 1000 << " μs (" << recomputed << " recomputed)\n";
+    std::cout << "   Average: " << (static_cast<double>(snap_ns.count()) / 10000.0)
+              << " ns per refresh\n\n";
+
+    // Passive-heavy workload: bids below 100, asks above, nothing crosses
+    OrderBook passive_book;
+    std::uniform_real_distribution<> offset_dist(0.01, 5.0);
+
+    start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < num_orders; ++i) {
+        bool is_buy = side_dist(gen) == 0;
+        double offset = std::round(offset_dist(gen) * 100.0) / 100.0;
+        double price = is_buy ? 100.0 - offset : 100.0 + offset;
+        passive_book.add_order(Order(i + 1, is_buy, price, qty_dist(gen), get_timestamp_ns()));
+    }
+    end = std::chrono::high_resolution_clock::now();
+    duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+
+    std::cout << " Added " << num_orders << " passive orders in "
+              << duration.count() << " μs\n";
+    std::cout << "   Average: " << (static_cast<double>(duration.count()) / static_cast<double>(num_orders))
+              << " μs per order\n\n";
+
+    // Strategies poll the top of book constantly
+    const size_t num_polls = 1000000;
+    double best_price = 0.0;
+    uint64_t best_qty = 0;
+    uint64_t checksum = 0;
+
+    start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < num_polls; ++i) {
+        if (passive_book.get_best_bid(best_price, best_qty)) checksum += best_qty;
+        if (passive_book.get_best_ask(best_price, best_qty)) checksum += best_qty;
+    }
+    end = std::chrono::high_resolution_clock::now();
+    auto poll_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+
+    std::cout << " Polled best bid/ask " << num_polls << " times in "
+              << poll_ns.count() / 1000 << " μs (checksum " << checksum << ")\n";
+    std::cout << "   Average: " << (static_cast<double>(poll_ns.count()) / static_cast<double>(num_polls))
+              << " ns per poll\n\n";
+
     // Display final state
     std::cout << "Final order book state:\n";
     book.print_book(10);
@@ -190,7 +252,968 @@ void test_performance() {
     std::cout << "  Cancelled " << cancelled_count << " orders in " 
               << duration.count() << " μs\n";
     std::cout << "   Average: " << (duration.count() / static_cast<double>(cancelled_count)) 
-              << " μs per cancellation\n";
+              << " μs per cancellation\n\n";
+
+    // Tail latency of every operation above (HFT_LATENCY_STATS builds)
+    book.print_latency_stats();
+}
+
+// Memory pool statistics and idle release
+void test_memory_pool_release() {
+    std::cout << "\n╔════════════════════════════════════════════════════════════╗\n";
+    std::cout << "║         TEST 5: MEMORY POOL STATS & IDLE RELEASE           ║\n";
+    std::cout << "╚════════════════════════════════════════════════════════════╝\n";
+
+    OrderBook book;
+    PoolReleasePolicy policy;
+    policy.enabled = true;
+    policy.min_retained_blocks = 1;
+    book.set_pool_release_policy(policy);
+
+    // Burst of passive bids that forces the pool to grow
+    const size_t burst = 20000;
+    for (size_t i = 0; i < burst; ++i) {
+        double price = 90.0 + static_cast<double>(i % 100) * 0.01;
+        book.add_order(Order(i + 1, true, price, 10, get_timestamp_ns()));
+    }
+
+    MemoryPoolStats stats = book.pool_stats();
+    std::cout << " After burst: " << stats.block_count << " blocks, "
+              << stats.live << " live, peak " << stats.peak_live << "\n";
+
+    // Cancel everything except the last order, then release during idle
+    for (size_t i = 1; i < burst; ++i) {
+        book.cancel_order(i);
+    }
+
+    size_t occupied = 0;
+    for (const auto& block : book.pool_occupancy()) {
+        if (block.live > 0) occupied++;
+    }
+    std::cout << " Blocks with live orders: " << occupied << "\n";
+
+    size_t released = book.on_idle();
+    stats = book.pool_stats();
+    std::cout << " Released " << released << " blocks, " << stats.block_count
+              << " remain (" << stats.live << " live, " << stats.free << " free)\n";
+    std::cout << (stats.live == 1 && stats.block_count <= 2
+                  ? "✅ Idle release returned free blocks\n"
+                  : "❌ Unexpected pool state\n");
+}
+
+// Incremental depth snapshot and level deltas
+void test_incremental_snapshot() {
+    std::cout << "\n╔════════════════════════════════════════════════════════════╗\n";
+    std::cout << "║         TEST 6: INCREMENTAL SNAPSHOT & LEVEL DELTAS        ║\n";
+    std::cout << "╚════════════════════════════════════════════════════════════╝\n";
+
+    OrderBook book;
+    DepthSnapshot snapshot(book, 5);
+    std::vector<LevelUpdate> deltas;
+
+    book.add_order(Order(1, true, 100.0, 50, get_timestamp_ns()));
+    book.add_order(Order(2, true, 100.0, 25, get_timestamp_ns()));
+    book.add_order(Order(3, true, 99.5, 40, get_timestamp_ns()));
+    book.add_order(Order(4, false, 101.0, 30, get_timestamp_ns()));
+
+    auto print_deltas = [&](const char* label) {
+        snapshot.collect_deltas(book, deltas);
+        std::cout << " " << label << ": " << deltas.size() << " level change(s)\n";
+        for (const auto& d : deltas) {
+            std::cout << "   " << (d.is_bid ? "BID " : "ASK ") << d.price
+                      << " -> qty " << d.total_quantity
+                      << " (" << d.order_count << " orders)"
+                      << (d.order_count == 0 ? " [deleted]" : "") << "\n";
+        }
+    };
+
+    print_deltas("After 4 adds");
+
+    bool changed = snapshot.refresh(book);
+    bool changed_again = snapshot.refresh(book);
+    std::cout << " First refresh recomputed: " << (changed ? "yes" : "no")
+              << ", second: " << (changed_again ? "yes" : "no") << "\n";
+
+    book.cancel_order(3);
+    book.amend_order(2, 100.0, 10);
+    print_deltas("After cancel #3 and amend #2");
+    print_deltas("With no further changes");
+}
+
+// L2 market data: publisher -> shared-memory ring -> rebuilder
+void test_l2_market_data() {
+    std::cout << "\n╔════════════════════════════════════════════════════════════╗\n";
+    std::cout << "║         TEST 7: L2 MARKET DATA PUBLISH & REBUILD           ║\n";
+    std::cout << "╚════════════════════════════════════════════════════════════╝\n";
+
+    std::string ring_name = "/hft_l2_demo_" + std::to_string(getpid());
+    MdRing ring = MdRing::create(ring_name, 1 << 14);
+    MdRing consumer_ring = MdRing::open(ring_name);  // as a separate process would
+
+    OrderBook book;
+    MarketDataPublisher publisher(book, ring, 1000);
+    L2BookRebuilder rebuilder(consumer_ring, true);
+    L2BookRebuilder late_joiner(consumer_ring);
+
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<> action_dist(0, 9);
+    std::uniform_int_distribution<> tick_dist(-20, 20);
+    std::uniform_int_distribution<uint64_t> qty_dist(1, 500);
+    std::vector<uint64_t> live_ids;
+    uint64_t next_id = 1;
+    const size_t num_events = 20000;
+
+    for (size_t i = 0; i < num_events; ++i) {
+        int action = action_dist(gen);
+        if (action < 6 || live_ids.empty()) {
+            // Mostly passive adds, with a few that cross the mid
+            bool is_buy = (action & 1) == 0;
+            double price = 100.0 + tick_dist(gen) * 0.05 + (is_buy ? -0.5 : 0.5);
+            book.add_order(Order(next_id, is_buy, price, qty_dist(gen), get_timestamp_ns()));
+            live_ids.push_back(next_id++);
+        } else {
+            size_t idx = static_cast<size_t>(gen() % live_ids.size());
+            uint64_t id = live_ids[idx];
+            if (action < 9) {
+                book.cancel_order(id);
+            } else {
+                book.amend_order(id, 100.0 + tick_dist(gen) * 0.05, qty_dist(gen));
+            }
+            live_ids[idx] = live_ids.back();
+            live_ids.pop_back();
+        }
+        publisher.publish();
+
+        // The main consumer keeps up; the late joiner starts halfway through
+        rebuilder.poll();
+        if (i >= num_events / 2) {
+            late_joiner.poll();
+        }
+    }
+
+    auto matches_source = [&](const L2BookRebuilder& consumer) {
+        std::vector<PriceLevel> src_bids, src_asks, dst_bids, dst_asks;
+        book.get_snapshot(std::numeric_limits<size_t>::max(), src_bids, src_asks);
+        consumer.get_snapshot(std::numeric_limits<size_t>::max(), dst_bids, dst_asks);
+        auto same = [](const std::vector<PriceLevel>& a, const std::vector<PriceLevel>& b) {
+            if (a.size() != b.size()) return false;
+            for (size_t i = 0; i < a.size(); ++i) {
+                if (a[i].price != b[i].price || a[i].total_quantity != b[i].total_quantity ||
+                    a[i].order_count != b[i].order_count) {
+                    return false;
+                }
+            }
+            return true;
+        };
+        return consumer.synced() && same(src_bids, dst_bids) && same(src_asks, dst_asks);
+    };
+
+    std::cout << " Published " << publisher.messages_published() << " messages for "
+              << num_events << " book events\n";
+    std::cout << " Rebuilder: " << rebuilder.bid_levels() << " bid / "
+              << rebuilder.ask_levels() << " ask levels, " << rebuilder.trades()
+              << " trades, " << rebuilder.gaps() << " gaps\n";
+    std::cout << (matches_source(rebuilder)
+                  ? "✅ Rebuilt book matches source exactly\n"
+                  : "❌ Rebuilt book differs from source\n");
+    std::cout << (matches_source(late_joiner)
+                  ? "✅ Late joiner synchronized from full refresh\n"
+                  : "❌ Late joiner out of sync\n");
+}
+
+// Market-by-order feed handler with gap recovery
+void test_mbo_feed_handler() {
+    std::cout << "\n╔════════════════════════════════════════════════════════════╗\n";
+    std::cout << "║         TEST 8: MBO FEED HANDLER & GAP RECOVERY            ║\n";
+    std::cout << "╚════════════════════════════════════════════════════════════╝\n";
+
+    std::vector<MboMessage> stream;
+    generate_mbo_stream(50000, 11, stream);
+
+    // The venue's own view, and our mirror which loses messages 20001-20010
+    OrderBook venue_book(BookMode::Passive);
+    OrderBook mirror_book(BookMode::Passive);
+    venue_book.set_trade_handler([](const Trade&, void*) {}, nullptr);
+    mirror_book.set_trade_handler([](const Trade&, void*) {}, nullptr);
+    MboFeedHandler venue(venue_book);
+    MboFeedHandler mirror(mirror_book);
+    MboSnapshot snapshot;
+
+    for (const MboMessage& msg : stream) {
+        venue.on_message(msg);
+        if (msg.seq <= 20000 || msg.seq > 20010) {
+            mirror.on_message(msg);
+        }
+        // Snapshot channel delivers an image some time after the gap
+        if (msg.seq == 25000 && mirror.needs_recovery()) {
+            std::cout << " Gap detected, " << (msg.seq - 20010)
+                      << " messages buffered; recovering from snapshot @ seq " << msg.seq << "\n";
+            take_mbo_snapshot(venue_book, msg.seq, snapshot);
+            mirror.apply_snapshot(snapshot);
+        }
+    }
+
+    std::vector<Order> venue_orders, mirror_orders;
+    venue_book.for_each_order([&](const Order& o) { venue_orders.push_back(o); });
+    mirror_book.for_each_order([&](const Order& o) { mirror_orders.push_back(o); });
+    bool same = venue_orders.size() == mirror_orders.size();
+    for (size_t i = 0; same && i < venue_orders.size(); ++i) {
+        same = venue_orders[i].order_id == mirror_orders[i].order_id &&
+               venue_orders[i].price == mirror_orders[i].price &&
+               venue_orders[i].quantity == mirror_orders[i].quantity;
+    }
+
+    const MboFeedHandler::Stats& stats = mirror.stats();
+    std::cout << " Mirror applied " << stats.messages_applied << " messages, "
+              << stats.gaps << " gap(s), " << stats.recoveries << " recovery, "
+              << stats.unknown_orders << " unknown ids\n";
+    std::cout << " Resting orders: " << mirror_orders.size() << " across "
+              << mirror_book.bid_levels() << " bid / " << mirror_book.ask_levels()
+              << " ask levels, " << mirror_book.total_orders_matched() << " venue fills\n";
+
+    // A matching book would re-match the venue's adds, so it is refused
+    OrderBook matching_book;
+    bool rejected = false;
+    try {
+        MboFeedHandler wrong(matching_book);
+    } catch (const std::invalid_argument&) {
+        rejected = true;
+    }
+    std::cout << " Handler on a matching book:   " << (rejected ? "rejected" : "accepted") << "\n";
+    std::cout << (same && !mirror.needs_recovery() && rejected
+                  ? "✅ Mirror book matches venue order-for-order\n"
+                  : "❌ Mirror book diverged from venue\n");
+}
+
+// Write-ahead journal and crash recovery by replay
+void test_journal_recovery() {
+    std::cout << "\n╔════════════════════════════════════════════════════════════╗\n";
+    std::cout << "║         TEST 9: JOURNAL & RECOVERY BY REPLAY               ║\n";
+    std::cout << "╚════════════════════════════════════════════════════════════╝\n";
+
+    std::string path = "/tmp/hft_journal_demo_" + std::to_string(getpid()) + ".bin";
+    unlink(path.c_str());
+
+    OrderBook book;
+    book.set_trade_handler([](const Trade&, void*) {}, nullptr);
+    std::mt19937 gen(21);
+    std::uniform_int_distribution<> action_dist(0, 9);
+    std::uniform_int_distribution<> tick_dist(-30, 30);
+    std::uniform_int_distribution<uint64_t> qty_dist(1, 300);
+    uint64_t next_id = 1;
+
+    {
+        JournalConfig config;
+        config.policy = DurabilityPolicy::GroupCommit;
+        Journal journal(path, config);
+
+        for (size_t i = 0; i < 20000; ++i) {
+            int action = action_dist(gen);
+            if (action < 6 || next_id < 10) {
+                Order order(next_id++, (action & 1) == 0, 100.0 + tick_dist(gen) * 0.05,
+                            qty_dist(gen), get_timestamp_ns());
+                book.add_order(order);
+                journal.record_add(order);
+            } else {
+                uint64_t id = 1 + gen() % (next_id - 1);
+                if (action < 9) {
+                    if (book.cancel_order(id)) journal.record_cancel(id);
+                } else {
+                    double price = 100.0 + tick_dist(gen) * 0.05;
+                    uint64_t qty = qty_dist(gen);
+                    if (book.amend_order(id, price, qty)) journal.record_amend(id, price, qty);
+                }
+            }
+        }
+        bool durable = journal.wait_durable(journal.last_seq());
+        std::cout << " Journaled " << journal.last_seq() << " accepted inputs (group commit)"
+                  << (durable ? "" : " (journal FAILED)") << "\n";
+    }
+
+    // "Crash": rebuild a fresh book from the journal alone
+    OrderBook recovered;
+    recovered.set_trade_handler([](const Trade&, void*) {}, nullptr);
+    size_t replayed = Journal::replay(path, recovered);
+
+    std::vector<Order> original_orders, recovered_orders;
+    book.for_each_order([&](const Order& o) { original_orders.push_back(o); });
+    recovered.for_each_order([&](const Order& o) { recovered_orders.push_back(o); });
+    bool same = original_orders.size() == recovered_orders.size() &&
+                book.total_orders_matched() == recovered.total_orders_matched();
+    for (size_t i = 0; same && i < original_orders.size(); ++i) {
+        same = original_orders[i].order_id == recovered_orders[i].order_id &&
+               original_orders[i].price == recovered_orders[i].price &&
+               original_orders[i].quantity == recovered_orders[i].quantity;
+    }
+
+    std::cout << " Replayed " << replayed << " records -> " << recovered_orders.size()
+              << " resting orders, " << recovered.total_orders_matched() << " fills\n";
+
+    // Any version from 1 up is still read; a newer one is refused
+    auto stamp_version = [&](uint32_t version) {
+        std::FILE* file = std::fopen(path.c_str(), "r+b");
+        if (!file) return;
+        std::fseek(file, static_cast<long>(offsetof(JournalFileHeader, version)), SEEK_SET);
+        std::fwrite(&version, sizeof(version), 1, file);
+        std::fclose(file);
+    };
+    stamp_version(1);
+    OrderBook oldest;
+    oldest.set_trade_handler([](const Trade&, void*) {}, nullptr);
+    size_t oldest_replayed = Journal::replay(path, oldest);
+    stamp_version(kJournalVersion + 1);
+    OrderBook newer;
+    size_t newer_replayed = Journal::replay(path, newer);
+    std::cout << " Version 1 header: " << oldest_replayed << " records replayed; version "
+              << kJournalVersion + 1 << " header: " << newer_replayed << "\n";
+    same = same && oldest_replayed == replayed && newer_replayed == 0;
+    std::cout << (same ? "✅ Recovered book matches the original\n"
+                       : "❌ Recovered book differs from the original\n");
+    unlink(path.c_str());
+}
+
+// Recovery from a forked snapshot plus the journal records after it
+void test_snapshot_recovery() {
+    std::cout << "\n╔════════════════════════════════════════════════════════════╗\n";
+    std::cout << "║         TEST 10: SNAPSHOT + JOURNAL TAIL RECOVERY          ║\n";
+    std::cout << "╚════════════════════════════════════════════════════════════╝\n";
+
+    std::string journal_path = "/tmp/hft_snapshot_demo_" + std::to_string(getpid()) + ".bin";
+    std::string snapshot_path = "/tmp/hft_snapshot_demo_" + std::to_string(getpid()) + ".snap";
+    unlink(journal_path.c_str());
+
+    OrderBook book;
+    book.set_trade_handler([](const Trade&, void*) {}, nullptr);
+    std::mt19937 gen(34);
+    std::uniform_int_distribution<> action_dist(0, 9);
+    std::uniform_int_distribution<> tick_dist(-30, 30);
+    std::uniform_int_distribution<uint64_t> qty_dist(1, 300);
+    uint64_t next_id = 1;
+    uint64_t snapshot_seq = 0;
+    bool snapshot_ok = false;
+
+    {
+        Journal journal(journal_path);
+        for (size_t i = 0; i < 20000; ++i) {
+            if (i == 10000) {
+                // Copy-on-write snapshot in a forked child; the book keeps going
+                snapshot_seq = journal.last_seq();
+                pid_t child = book.save_snapshot_async(snapshot_path, snapshot_seq);
+                snapshot_ok = OrderBook::wait_snapshot(child);
+            }
+            int action = action_dist(gen);
+            if (action < 6 || next_id < 10) {
+                Order order(next_id++, (action & 1) == 0, 100.0 + tick_dist(gen) * 0.05,
+                            qty_dist(gen), get_timestamp_ns());
+                book.add_order(order);
+                journal.record_add(order);
+            } else {
+                uint64_t id = 1 + gen() % (next_id - 1);
+                if (action < 9) {
+                    if (book.cancel_order(id)) journal.record_cancel(id);
+                } else {
+                    double price = 100.0 + tick_dist(gen) * 0.05;
+                    uint64_t qty = qty_dist(gen);
+                    if (book.amend_order(id, price, qty)) journal.record_amend(id, price, qty);
+                }
+            }
+        }
+        bool durable = journal.wait_durable(journal.last_seq());
+        std::cout << " Snapshot at journal seq " << snapshot_seq << " of " << journal.last_seq()
+                  << (snapshot_ok ? "" : " (snapshot FAILED)") << (durable ? "" : " (journal FAILED)")
+                  << "\n";
+    }
+
+    // Recover: bulk-load the snapshot, then replay only the journal tail
+    OrderBook recovered;
+    recovered.set_trade_handler([](const Trade&, void*) {}, nullptr);
+    uint64_t loaded_seq = 0;
+    bool loaded = recovered.load_snapshot(snapshot_path, &loaded_seq);
+    size_t replayed = Journal::replay(journal_path, recovered, loaded_seq);
+
+    std::vector<Order> original_orders, recovered_orders;
+    book.for_each_order([&](const Order& o) { original_orders.push_back(o); });
+    recovered.for_each_order([&](const Order& o) { recovered_orders.push_back(o); });
+    bool same = loaded && loaded_seq == snapshot_seq &&
+                original_orders.size() == recovered_orders.size() &&
+                book.total_orders_matched() == recovered.total_orders_matched();
+    for (size_t i = 0; same && i < original_orders.size(); ++i) {
+        same = original_orders[i].order_id == recovered_orders[i].order_id &&
+               original_orders[i].price == recovered_orders[i].price &&
+               original_orders[i].quantity == recovered_orders[i].quantity &&
+               original_orders[i].timestamp_ns == recovered_orders[i].timestamp_ns;
+    }
+
+    std::cout << " Loaded snapshot, replayed " << replayed << " tail records -> "
+              << recovered_orders.size() << " resting orders\n";
+    std::cout << (same ? "✅ Snapshot + tail recovery matches the original\n"
+                       : "❌ Snapshot + tail recovery differs from the original\n");
+    unlink(journal_path.c_str());
+    unlink(snapshot_path.c_str());
+}
+
+// IOC / FOK / market orders trade on arrival and never rest
+void test_order_types() {
+    std::cout << "\n╔════════════════════════════════════════════════════════════╗\n";
+    std::cout << "║         TEST 11: IOC / FOK / MARKET ORDERS                 ║\n";
+    std::cout << "╚════════════════════════════════════════════════════════════╝\n";
+
+    OrderBook book;
+    struct Fills {
+        uint64_t trades = 0;
+        uint64_t quantity = 0;
+    } fills;
+    book.set_trade_handler([](const Trade& trade, void* context) {
+        auto* f = static_cast<Fills*>(context);
+        f->trades++;
+        f->quantity += trade.quantity;
+    }, &fills);
+
+    book.add_order(Order(1, false, 101.0, 50, get_timestamp_ns()));
+    book.add_order(Order(2, false, 101.5, 50, get_timestamp_ns()));
+    book.add_order(Order(3, true, 99.0, 100, get_timestamp_ns()));
+
+    // IOC for 80 @ 101.0: fills 50, the other 30 is cancelled, nothing rests
+    book.add_order(Order(10, true, 101.0, 80, get_timestamp_ns(), OrderType::Limit, TimeInForce::Ioc));
+    Order unused;
+    bool ioc_ok = fills.quantity == 50 && !book.get_order(10, unused) && book.bid_levels() == 1;
+    std::cout << " IOC 80 @ 101.0 -> filled " << fills.quantity << ", rests: "
+              << (book.get_order(10, unused) ? "yes" : "no") << "\n";
+
+    // FOK for 60 @ 101.5 sees only 50 of depth: killed, no trades
+    uint64_t before = fills.quantity;
+    book.add_order(Order(11, true, 101.5, 60, get_timestamp_ns(), OrderType::Limit, TimeInForce::Fok));
+    bool fok_kill_ok = fills.quantity == before && book.ask_levels() == 1;
+    std::cout << " FOK 60 @ 101.5 (50 available) -> filled " << fills.quantity - before << "\n";
+
+    // FOK for 50 fits exactly
+    before = fills.quantity;
+    book.add_order(Order(12, true, 101.5, 50, get_timestamp_ns(), OrderType::Limit, TimeInForce::Fok));
+    bool fok_fill_ok = fills.quantity - before == 50 && book.ask_levels() == 0;
+    std::cout << " FOK 50 @ 101.5 (50 available) -> filled " << fills.quantity - before << "\n";
+
+    // Market sell for 150 takes the 100 bid and drops the rest
+    before = fills.quantity;
+    book.add_order(Order(13, false, 0.0, 150, get_timestamp_ns(), OrderType::Market));
+    bool market_ok = fills.quantity - before == 100 && book.bid_levels() == 0 &&
+                     book.ask_levels() == 0;
+    std::cout << " Market sell 150 (100 bid) -> filled " << fills.quantity - before
+              << ", book empty: " << (book.bid_levels() + book.ask_levels() == 0 ? "yes" : "no") << "\n";
+
+    // A crossing GTC limit rests its remainder as before
+    book.add_order(Order(4, false, 100.0, 20, get_timestamp_ns()));
+    book.add_order(Order(14, true, 100.0, 30, get_timestamp_ns()));
+    Order rest;
+    bool gtc_ok = book.get_order(14, rest) && rest.quantity == 10;
+    std::cout << " GTC 30 @ 100.0 vs 20 resting -> rests " << (gtc_ok ? rest.quantity : 0) << "\n";
+
+    std::cout << " Added " << book.total_orders_added() << ", cancelled " << book.total_orders_cancelled()
+              << ", trades " << book.total_orders_matched() << "\n";
+    std::cout << (ioc_ok && fok_kill_ok && fok_fill_ok && market_ok && gtc_ok
+                      ? "✅ Order types behave as specified\n"
+                      : "❌ Order type behavior is wrong\n");
+}
+
+// Iceberg orders: displayed slice, hidden reserve, replenishment to the back
+void test_iceberg_orders() {
+    std::cout << "\n╔════════════════════════════════════════════════════════════╗\n";
+    std::cout << "║         TEST 12: ICEBERG ORDERS                            ║\n";
+    std::cout << "╚════════════════════════════════════════════════════════════╝\n";
+
+    OrderBook book;
+    book.set_trade_handler([](const Trade&, void*) {}, nullptr);
+
+    Order iceberg(1, false, 101.0, 100, get_timestamp_ns());
+    iceberg.display_quantity = 30;
+    book.add_order(iceberg);
+    book.add_order(Order(2, false, 101.0, 20, get_timestamp_ns()));
+
+    std::vector<PriceLevel> bids, asks;
+    book.get_snapshot(1, bids, asks);
+    bool split_ok = asks.size() == 1 && asks[0].total_quantity == 50 && asks[0].hidden_quantity == 70;
+    std::cout << " Iceberg 100 showing 30 + plain 20 -> displayed " << asks[0].total_quantity
+              << ", hidden " << asks[0].hidden_quantity << "\n";
+
+    // Taking the 30-lot slice replenishes it behind order #2
+    book.add_order(Order(10, true, 101.0, 30, get_timestamp_ns()));
+    std::vector<uint64_t> queue;
+    book.for_each_order([&](const Order& o) { queue.push_back(o.order_id); });
+    Order resting{};
+    book.get_order(1, resting);
+    bool requeue_ok = queue == std::vector<uint64_t>{2, 1} && resting.quantity == 30 &&
+                      resting.hidden_quantity == 40;
+    std::cout << " After one slice fills: queue #" << queue[0] << ", #" << queue[1]
+              << " | iceberg shows " << resting.quantity << ", hidden " << resting.hidden_quantity << "\n";
+
+    // A FOK larger than the displayed depth fills against the reserve
+    book.add_order(Order(11, true, 101.0, 80, get_timestamp_ns(), OrderType::Limit, TimeInForce::Fok));
+    bool reserve_ok = book.get_order(1, resting) && resting.quantity == 10 &&
+                      resting.hidden_quantity == 0 && !resting.is_iceberg();
+    std::cout << " FOK 80 across display + reserve -> iceberg left with " << resting.quantity
+              << " (plain order now)\n";
+
+    // Venue executions in a passive book fill the displayed slice, then
+    // replenish to the back; only a partial cancel takes the reserve first
+    OrderBook mirror(BookMode::Passive);
+    mirror.set_trade_handler([](const Trade&, void*) {}, nullptr);
+    Order mirrored(1, false, 101.0, 100, get_timestamp_ns());
+    mirrored.display_quantity = 30;
+    mirror.add_order(mirrored);
+    mirror.add_order(Order(2, false, 101.0, 20, get_timestamp_ns()));
+    Order slice{};
+    mirror.execute_order(1, 10);
+    bool execute_ok = mirror.get_order(1, slice) && slice.quantity == 20 && slice.hidden_quantity == 70;
+    mirror.execute_order(1, 20);
+    queue.clear();
+    mirror.for_each_order([&](const Order& o) { queue.push_back(o.order_id); });
+    execute_ok = execute_ok && mirror.get_order(1, slice) && slice.quantity == 30 &&
+                 slice.hidden_quantity == 40 && queue == std::vector<uint64_t>{2, 1};
+    mirror.reduce_order(1, 50);
+    execute_ok = execute_ok && mirror.get_order(1, slice) && slice.quantity == 20 &&
+                 slice.hidden_quantity == 0;
+    mirror.get_snapshot(1, bids, asks);
+    execute_ok = execute_ok && asks.size() == 1 && asks[0].total_quantity == 40 &&
+                 asks[0].hidden_quantity == 0;
+    // An empty execution reports nothing, and a matching book refuses them
+    uint64_t fills = mirror.total_orders_matched();
+    execute_ok = execute_ok && mirror.execute_order(1, 0) && mirror.total_orders_matched() == fills &&
+                 !book.execute_order(1, 5);
+    std::cout << " Passive book: execute 10 + 20 requeues behind #2, reduce 50 -> shows "
+              << slice.quantity << ", hidden " << slice.hidden_quantity << "\n";
+
+    // Snapshot round trip keeps a live reserve
+    Order second(3, true, 99.0, 500, get_timestamp_ns());
+    second.display_quantity = 50;
+    book.add_order(second);
+    std::string path = "/tmp/hft_iceberg_demo_" + std::to_string(getpid()) + ".snap";
+    OrderBook restored;
+    bool snapshot_ok = book.save_snapshot(path) && restored.load_snapshot(path);
+    Order restored_order{};
+    snapshot_ok = snapshot_ok && restored.get_order(3, restored_order) &&
+                  restored_order.quantity == 50 && restored_order.hidden_quantity == 450 &&
+                  restored_order.display_quantity == 50;
+    restored.get_snapshot(1, bids, asks);
+    snapshot_ok = snapshot_ok && bids.size() == 1 && bids[0].hidden_quantity == 450;
+    std::cout << " Snapshot round trip: bid shows " << restored_order.quantity << ", hidden "
+              << restored_order.hidden_quantity << "\n";
+    unlink(path.c_str());
+
+    std::cout << (split_ok && requeue_ok && reserve_ok && execute_ok && snapshot_ok
+                      ? "✅ Icebergs display, replenish and persist correctly\n"
+                      : "❌ Iceberg behavior is wrong\n");
+}
+
+// Stop and stop-limit orders: trigger order, cascades, cancel and snapshot
+void test_stop_orders() {
+    std::cout << "\n╔════════════════════════════════════════════════════════════╗\n";
+    std::cout << "║         TEST 13: STOP ORDERS                               ║\n";
+    std::cout << "╚════════════════════════════════════════════════════════════╝\n";
+
+    std::vector<Trade> trades;
+    auto record = [](const Trade& t, void* ctx) { static_cast<std::vector<Trade>*>(ctx)->push_back(t); };
+
+    OrderBook book;
+    book.set_trade_handler(record, &trades);
+    book.add_order(Order(1, false, 101.0, 50, get_timestamp_ns()));
+    book.add_order(Order(2, false, 102.0, 50, get_timestamp_ns()));
+    book.add_order(Order(3, true, 99.0, 50, get_timestamp_ns()));
+    book.add_order(Order(4, true, 98.0, 50, get_timestamp_ns()));
+
+    // Two buy stops at 101 (market, then stop-limit at 101.50), one at 102
+    // that only the first stop's own trades can reach, and a sell stop at 99
+    book.add_stop_order(Order(20, true, 0.0, 60, get_timestamp_ns(), OrderType::Market), 101.0);
+    book.add_stop_order(Order(21, true, 101.5, 10, get_timestamp_ns()), 101.0);
+    book.add_stop_order(Order(23, true, 0.0, 5, get_timestamp_ns(), OrderType::Market), 102.0);
+    book.add_stop_order(Order(22, false, 0.0, 10, get_timestamp_ns(), OrderType::Market), 99.0);
+    std::cout << " Pending stops: " << book.pending_stops() << "\n";
+
+    book.add_order(Order(30, true, 101.0, 10, get_timestamp_ns()));
+    for (const Trade& t : trades) {
+        std::cout << " TRADE #" << t.buy_order_id << " x #" << t.sell_order_id
+                  << " | Qty: " << t.quantity << " | Price: " << t.price << "\n";
+    }
+    auto same = [](const Trade& t, uint64_t buy, uint64_t sell, double price, uint64_t qty) {
+        return t.buy_order_id == buy && t.sell_order_id == sell && t.price == price && t.quantity == qty;
+    };
+    bool cascade_ok = trades.size() == 4 && same(trades[0], 30, 1, 101.0, 10) &&
+                      same(trades[1], 20, 1, 101.0, 40) && same(trades[2], 20, 2, 102.0, 20) &&
+                      same(trades[3], 23, 2, 102.0, 5);
+    double price = 0;
+    uint64_t qty = 0;
+    bool limit_ok = book.get_best_bid(price, qty) && price == 101.5 && qty == 10 &&
+                    book.pending_stops() == 1;
+    std::cout << " Stop-limit #21 rests at " << price << " x " << qty
+              << " | pending stops: " << book.pending_stops() << "\n";
+
+    bool cancel_ok = book.cancel_order(22) && book.pending_stops() == 0 && !book.cancel_order(22);
+    std::cout << " Cancel pending stop #22: " << (cancel_ok ? "ok" : "failed") << "\n";
+
+    // Snapshot round trip keeps a pending stop, which still triggers
+    book.add_stop_order(Order(40, false, 0.0, 5, get_timestamp_ns(), OrderType::Market), 98.5);
+    std::string path = "/tmp/hft_stop_demo_" + std::to_string(getpid()) + ".snap";
+    OrderBook restored;
+    restored.set_trade_handler(record, &trades);
+    bool snapshot_ok = book.save_snapshot(path) && restored.load_snapshot(path) &&
+                       restored.pending_stops() == 1;
+    restored.add_order(Order(41, false, 0.0, 70, get_timestamp_ns(), OrderType::Market));
+    snapshot_ok = snapshot_ok && restored.pending_stops() == 0 &&
+                  restored.get_best_bid(price, qty) && price == 98.0 && qty == 35;
+    std::cout << " Restored stop #40 triggered by a print at 98 -> best bid " << price
+              << " x " << qty << "\n";
+    unlink(path.c_str());
+
+    std::cout << (cascade_ok && limit_ok && cancel_ok && snapshot_ok
+                      ? "✅ Stops trigger in order, cascade and persist correctly\n"
+                      : "❌ Stop order behavior is wrong\n");
+}
+
+// Good-till-time orders expired by the engine clock
+void test_gtt_orders() {
+    std::cout << "\n╔════════════════════════════════════════════════════════════╗\n";
+    std::cout << "║         TEST 14: GOOD-TILL-TIME EXPIRY                     ║\n";
+    std::cout << "╚════════════════════════════════════════════════════════════╝\n";
+
+    OrderBook book;
+    book.set_trade_handler([](const Trade&, void*) {}, nullptr);
+    book.advance_time(1000);
+
+    auto gtt = [](uint64_t id, bool is_buy, double price, uint64_t expire_ns) {
+        Order order(id, is_buy, price, 10, get_timestamp_ns(), OrderType::Limit, TimeInForce::Gtt);
+        order.expire_ns = expire_ns;
+        return order;
+    };
+    book.add_order(gtt(1, false, 101.0, 5000));
+    book.add_order(gtt(2, true, 99.0, 3000));
+    book.add_order(Order(3, true, 99.0, 10, get_timestamp_ns()));
+    book.add_order(gtt(4, true, 98.0, 500));  // Already expired
+    Order order;
+    bool arrival_ok = book.pending_expiries() == 2 && !book.get_order(4, order);
+    std::cout << " Clock 1000: 2 GTT orders armed, one rejected as already expired\n";
+
+    size_t early = book.advance_time(2999);
+    size_t due = book.advance_time(3000);
+    bool expiry_ok = early == 0 && due == 1 && !book.get_order(2, order) && book.get_order(3, order);
+    std::cout << " Clock 2999 -> " << early << " expired | clock 3000 -> " << due
+              << " expired (#2), GTC #3 still resting\n";
+
+    // A price amend keeps the expiry; a fill disarms it
+    book.amend_order(1, 101.5, 10);
+    book.add_order(gtt(5, false, 102.0, 10000));
+    book.add_order(Order(10, true, 102.0, 20, get_timestamp_ns()));
+    bool disarm_ok = book.pending_expiries() == 0 && book.advance_time(20000) == 0;
+    std::cout << " Amended #1 and GTT #5 filled -> pending expiries: " << book.pending_expiries() << "\n";
+
+    // Snapshot round trip keeps the clock and re-arms the timer
+    book.add_order(gtt(6, true, 98.0, 30000));
+    std::string path = "/tmp/hft_gtt_demo_" + std::to_string(getpid()) + ".snap";
+    OrderBook restored;
+    bool snapshot_ok = book.save_snapshot(path) && restored.load_snapshot(path);
+    uint64_t restored_clock = restored.clock_ns();
+    snapshot_ok = snapshot_ok && restored_clock == 20000 && restored.pending_expiries() == 1 &&
+                  restored.advance_time(30000) == 1 && !restored.get_order(6, order);
+    std::cout << " Snapshot round trip: restored clock " << restored_clock
+              << ", GTT #6 expires at 30000\n";
+    unlink(path.c_str());
+
+    std::cout << (arrival_ok && expiry_ok && disarm_ok && snapshot_ok
+                      ? "✅ GTT orders expire on time and only once\n"
+                      : "❌ GTT expiry is wrong\n");
+}
+
+// Self-trade prevention: each mode against the same resting book
+void test_self_trade_prevention() {
+    std::cout << "\n╔════════════════════════════════════════════════════════════╗\n";
+    std::cout << "║         TEST 15: SELF-TRADE PREVENTION                     ║\n";
+    std::cout << "╚════════════════════════════════════════════════════════════╝\n";
+
+    std::vector<Trade> trades;
+    auto record = [](const Trade& t, void* ctx) { static_cast<std::vector<Trade>*>(ctx)->push_back(t); };
+    auto sell = [](uint64_t id, uint32_t participant, double price) {
+        Order order(id, false, price, 10, get_timestamp_ns());
+        order.participant_id = participant;
+        return order;
+    };
+
+    // Participant 7 rests #1 and #3, participant 8 rests #2 between them;
+    // participant 7 then buys 15 through both levels
+    auto run = [&](StpMode mode, OrderBook& book) {
+        trades.clear();
+        book.set_trade_handler(record, &trades);
+        book.add_order(sell(1, 7, 101.0));
+        book.add_order(sell(2, 8, 101.0));
+        book.add_order(sell(3, 7, 102.0));
+        Order buy(10, true, 102.0, 15, get_timestamp_ns());
+        buy.participant_id = 7;
+        buy.stp = mode;
+        book.add_order(buy);
+    };
+    auto resting = [](OrderBook& book, uint64_t id) {
+        Order order;
+        return book.get_order(id, order) ? order.quantity : 0;
+    };
+
+    OrderBook newest, oldest, both, decrement;
+    run(StpMode::CancelNewest, newest);
+    bool newest_ok = trades.empty() && resting(newest, 1) == 10 && resting(newest, 10) == 0;
+    std::cout << " Cancel newest:  " << trades.size() << " trades, incoming order cancelled\n";
+
+    run(StpMode::CancelOldest, oldest);
+    bool oldest_ok = trades.size() == 1 && trades[0].sell_order_id == 2 && trades[0].quantity == 10 &&
+                     resting(oldest, 1) == 0 && resting(oldest, 3) == 0 && resting(oldest, 10) == 5;
+    std::cout << " Cancel oldest:  #1 and #3 cancelled, 10 traded with #2, 5 rest as a bid\n";
+
+    run(StpMode::CancelBoth, both);
+    bool both_ok = trades.empty() && resting(both, 1) == 0 && resting(both, 2) == 10 &&
+                   resting(both, 10) == 0;
+    std::cout << " Cancel both:    #1 and the incoming order cancelled, no trades\n";
+
+    run(StpMode::Decrement, decrement);
+    bool decrement_ok = trades.size() == 1 && trades[0].sell_order_id == 2 && trades[0].quantity == 5 &&
+                        resting(decrement, 1) == 0 && resting(decrement, 2) == 5 &&
+                        resting(decrement, 10) == 0;
+    std::cout << " Decrement:      #1 decremented away, the remaining 5 traded with #2\n";
+
+    std::cout << (newest_ok && oldest_ok && both_ok && decrement_ok
+                      ? "✅ Self-trades prevented in every mode\n"
+                      : "❌ Self-trade prevention is wrong\n");
+}
+
+// Post-only (reject and slide) and the price band, against a 100.00 / 100.05 book
+void test_post_only_and_price_band() {
+    std::cout << "\n╔════════════════════════════════════════════════════════════╗\n";
+    std::cout << "║         TEST 16: POST-ONLY & PRICE BAND                    ║\n";
+    std::cout << "╚════════════════════════════════════════════════════════════╝\n";
+
+    OrderBook book;
+    std::vector<Trade> trades;
+    book.set_trade_handler([](const Trade& t, void* ctx) { static_cast<std::vector<Trade>*>(ctx)->push_back(t); },
+                           &trades);
+    book.add_order(Order(1, true, 100.00, 100, get_timestamp_ns()));
+    book.add_order(Order(2, false, 100.05, 100, get_timestamp_ns()));
+
+    // Post-only buy at the ask: rejected, the book is untouched
+    book.add_order(Order(10, true, 100.05, 50, get_timestamp_ns(), OrderType::PostOnly));
+    Order order;
+    bool reject_ok = trades.empty() && !book.get_order(10, order) && book.best_ask().quantity == 100;
+    std::cout << " Post-only buy @ 100.05:        rejected\n";
+
+    // Sliding post-only orders through the book rest one tick inside it;
+    // the sell slides against the new 100.04 bid
+    book.add_order(Order(11, true, 100.10, 50, get_timestamp_ns(), OrderType::PostOnlySlide));
+    book.add_order(Order(12, false, 99.90, 50, get_timestamp_ns(), OrderType::PostOnlySlide));
+    bool slide_ok = trades.empty() && book.get_order(11, order) && order.price == 100.04 &&
+                    book.get_order(12, order) && order.price == 100.05;
+    std::cout << " Slide buy @ 100.10 / sell @ 99.90: rest at " << std::fixed << std::setprecision(2)
+              << book.best_bid().price << " / " << book.best_ask().price << "\n";
+
+    // A non-crossing post-only order rests where it was priced
+    book.add_order(Order(13, true, 99.95, 50, get_timestamp_ns(), OrderType::PostOnly));
+    bool passive_ok = book.get_order(13, order) && order.price == 99.95;
+
+    // Post-only orders keep their type through a snapshot round trip
+    std::string path = "/tmp/hft_post_only_demo_" + std::to_string(getpid()) + ".snap";
+    OrderBook restored;
+    bool snapshot_ok = book.save_snapshot(path) && restored.load_snapshot(path) &&
+                       restored.get_order(13, order) && order.type == OrderType::PostOnly &&
+                       restored.get_order(11, order) && order.type == OrderType::PostOnlySlide &&
+                       restored.get_order(1, order) && order.type == OrderType::Limit;
+    unlink(path.c_str());
+    std::cout << " Snapshot round trip:           post-only types "
+              << (snapshot_ok ? "kept" : "lost") << "\n";
+
+    // Band of 0.50: a buy limit above 100.51 is rejected before it trades;
+    // a market sell stops 0.50 under the best bid
+    book.set_price_band(0.50);
+    book.add_order(Order(20, true, 101.00, 10, get_timestamp_ns()));
+    bool band_ok = trades.empty() && !book.get_order(20, order);
+    std::cout << " Band 0.50, buy @ 101.00:       rejected\n";
+
+    book.add_order(Order(21, true, 100.50, 10, get_timestamp_ns()));
+    bool inside_ok = trades.size() == 1 && trades[0].price == 100.05;
+    std::cout << " Band 0.50, buy @ 100.50:       traded " << trades.size() << " fill\n";
+
+    // Bids left: 100.04 x 50, 100.00 x 100, 99.95 x 50; the collar is 99.54
+    book.add_order(Order(30, true, 99.50, 500, get_timestamp_ns()));
+    trades.clear();
+    book.add_order(Order(31, false, 0.0, 1000, get_timestamp_ns(), OrderType::Market, TimeInForce::Ioc));
+    uint64_t sold = 0;
+    for (const Trade& trade : trades) sold += trade.quantity;
+    bool collar_ok = sold == 200 && book.get_order(30, order) && order.quantity == 500;
+    std::cout << " Market sell 1000 with the band: " << sold << " sold, 99.50 bid untouched\n";
+
+    std::cout << (reject_ok && slide_ok && passive_ok && snapshot_ok && band_ok && inside_ok &&
+                          collar_ok
+                      ? "✅ Post-only and price band checks hold\n"
+                      : "❌ Post-only or price band check is wrong\n");
+}
+
+// Amend priority: a cut keeps the queue position, an increase goes to the
+// back, a price move relinks the order and a crossing amend trades
+void test_amend_priority() {
+    std::cout << "\n╔════════════════════════════════════════════════════════════╗\n";
+    std::cout << "║         TEST 17: AMEND QUEUE PRIORITY                      ║\n";
+    std::cout << "╚════════════════════════════════════════════════════════════╝\n";
+
+    OrderBook book;
+    std::vector<Trade> trades;
+    book.set_trade_handler([](const Trade& t, void* ctx) { static_cast<std::vector<Trade>*>(ctx)->push_back(t); },
+                           &trades);
+    for (uint64_t id = 1; id <= 3; ++id) {
+        book.add_order(Order(id, false, 101.0, 10, get_timestamp_ns()));
+    }
+
+    // #1 cut to 5 stays first; #2 raised to 20 goes behind #3
+    book.amend_order(1, 101.0, 5);
+    book.amend_order(2, 101.0, 20);
+    book.add_order(Order(10, true, 101.0, 15, get_timestamp_ns()));
+    bool queue_ok = trades.size() == 2 && trades[0].sell_order_id == 1 && trades[0].quantity == 5 &&
+                    trades[1].sell_order_id == 3 && trades[1].quantity == 10;
+    std::cout << " Amend #1 down, #2 up, buy 15:  filled";
+    for (const Trade& trade : trades) std::cout << " #" << trade.sell_order_id << " x" << trade.quantity;
+    std::cout << "\n";
+
+    // A price move keeps the order (and its id) but joins the new level
+    book.amend_order(2, 101.5, 20);
+    Order order;
+    bool move_ok = book.get_order(2, order) && order.price == 101.5 && book.ask_levels() == 1 &&
+                   book.best_ask().price == 101.5 && book.best_ask().quantity == 20;
+    std::cout << " Amend #2 to 101.50:            best ask " << std::fixed << std::setprecision(2)
+              << book.best_ask().price << " x " << book.best_ask().quantity << "\n";
+
+    // A bid amended through the ask trades on the way
+    trades.clear();
+    book.add_order(Order(20, true, 100.0, 5, get_timestamp_ns()));
+    book.amend_order(20, 101.5, 5);
+    bool cross_ok = trades.size() == 1 && trades[0].buy_order_id == 20 && trades[0].sell_order_id == 2 &&
+                    book.get_order(2, order) && order.quantity == 15 && !book.get_order(20, order);
+    std::cout << " Amend bid #20 to 101.50:       " << trades.size() << " fill against #2\n";
+
+    // Amending to zero cancels
+    book.amend_order(2, 101.5, 0);
+    bool zero_ok = !book.get_order(2, order) && book.ask_levels() == 0;
+
+    std::cout << (queue_ok && move_ok && cross_ok && zero_ok
+                      ? "✅ Amends keep or give up priority as they should\n"
+                      : "❌ Amend priority is wrong\n");
+}
+
+// Fills per resting sell order, in order of first fill
+template<typename Policy>
+std::vector<std::pair<uint64_t, uint64_t>> policy_fills(BasicOrderBook<Policy>& book, uint64_t quantity) {
+    std::vector<Trade> trades;
+    book.set_trade_handler([](const Trade& t, void* ctx) { static_cast<std::vector<Trade>*>(ctx)->push_back(t); },
+                           &trades);
+    for (uint64_t id = 1; id <= 3; ++id) {
+        Order resting(id, false, 101.0, id == 1 ? 10 : id * 30 - 30, get_timestamp_ns());
+        resting.participant_id = id == 2 ? 7 : 1;
+        book.add_order(resting);
+    }
+    book.add_order(Order(10, true, 101.0, quantity, get_timestamp_ns()));
+    std::vector<std::pair<uint64_t, uint64_t>> fills;
+    for (uint64_t id = 1; id <= 3; ++id) {
+        uint64_t filled = 0;
+        for (const Trade& trade : trades) {
+            if (trade.sell_order_id == id) filled += trade.quantity;
+        }
+        fills.emplace_back(id, filled);
+    }
+    return fills;
+}
+
+void test_matching_policies() {
+    std::cout << "\n╔════════════════════════════════════════════════════════════╗\n";
+    std::cout << "║         TEST 18: MATCHING POLICIES                         ║\n";
+    std::cout << "╚════════════════════════════════════════════════════════════╝\n";
+
+    // Asks #1 x10, #2 x30 (participant 7), #3 x60 at 101.00, hit by a buy of 50
+    auto print = [](const char* name, const std::vector<std::pair<uint64_t, uint64_t>>& fills) {
+        std::cout << " " << name;
+        for (const auto& [id, filled] : fills) std::cout << " #" << id << " x" << filled;
+        std::cout << "\n";
+    };
+    using Fills = std::vector<std::pair<uint64_t, uint64_t>>;
+
+    BasicOrderBook<FifoPolicy> fifo;
+    Fills fifo_fills = policy_fills(fifo, 50);
+    print("FIFO:                  ", fifo_fills);
+
+    BasicOrderBook<ProRataPolicy> pro_rata;
+    Fills pro_rata_fills = policy_fills(pro_rata, 50);
+    print("Pro-rata:              ", pro_rata_fills);
+
+    // #1 opened the level, so it is the top order and fills first
+    BasicOrderBook<TopOrderProRataPolicy> top_order;
+    Fills top_order_fills = policy_fills(top_order, 50);
+    print("Top order + pro-rata:  ", top_order_fills);
+
+    // Participant 7 is the LMM with 40% of every fill at the level
+    BasicOrderBook<LmmPolicy> lmm;
+    lmm.policy().participant = 7;
+    lmm.policy().percent = 40;
+    Fills lmm_fills = policy_fills(lmm, 50);
+    print("LMM 40% + pro-rata:    ", lmm_fills);
+
+    bool ok = fifo_fills == Fills{{1, 10}, {2, 30}, {3, 10}} &&
+              pro_rata_fills == Fills{{1, 5}, {2, 15}, {3, 30}} &&
+              top_order_fills == Fills{{1, 10}, {2, 14}, {3, 26}} &&
+              lmm_fills == Fills{{1, 4}, {2, 24}, {3, 22}};
+    std::cout << (ok ? "✅ Each policy splits the fill as specified\n"
+                     : "❌ Policy allocation is wrong\n");
+}
+
+void test_call_auction() {
+    std::cout << "\n╔════════════════════════════════════════════════════════════╗\n";
+    std::cout << "║         TEST 19: CALL AUCTION                              ║\n";
+    std::cout << "╚════════════════════════════════════════════════════════════╝\n";
+
+    OrderBook book;
+    std::vector<Trade> trades;
+    book.set_trade_handler([](const Trade& t, void* ctx) { static_cast<std::vector<Trade>*>(ctx)->push_back(t); },
+                           &trades);
+    book.begin_auction();
+
+    // Bids 101.00 x300, 100.50 x200, 100.00 x400 against asks 99.50 x250,
+    // 100.00 x250, 100.50 x300: nothing trades while they accumulate
+    book.add_order(Order(1, true, 101.0, 300, get_timestamp_ns()));
+    book.add_order(Order(2, true, 100.5, 200, get_timestamp_ns()));
+    book.add_order(Order(3, true, 100.0, 400, get_timestamp_ns()));
+    book.add_order(Order(4, false, 99.5, 250, get_timestamp_ns()));
+    book.add_order(Order(5, false, 100.0, 250, get_timestamp_ns()));
+    book.add_order(Order(6, false, 100.5, 300, get_timestamp_ns()));
+    book.add_order(Order(7, true, 0.0, 100, get_timestamp_ns(), OrderType::Market));
+    bool call_ok = trades.empty() && book.in_auction() && book.total_orders_cancelled() == 1 &&
+                   book.best_bid().price > book.best_ask().price;
+    std::cout << " Call phase:       best bid " << std::fixed << std::setprecision(2) << book.best_bid().price
+              << " over best ask " << book.best_ask().price << ", market order rejected\n";
+
+    // 500 can trade at 100.00 and at 100.50; 100.50 leaves the smaller surplus
+    AuctionResult indicative = book.indicative_uncross();
+    AuctionResult result = book.uncross();
+    uint64_t traded = 0;
+    for (const Trade& trade : trades) {
+        traded += trade.quantity;
+    }
+    bool uncross_ok = indicative.price == 100.5 && result.price == 100.5 && result.volume == 500 &&
+                      result.buy_quantity == 500 && result.sell_quantity == 800 && trades.size() == 3 &&
+                      traded == 500 && !book.in_auction() && book.best_bid().price == 100.0 &&
+                      book.best_ask().price == 100.5 && book.best_ask().quantity == 300;
+    std::cout << " Uncross:          " << result.volume << " at " << result.price << " in " << trades.size()
+              << " trades; book now " << book.best_bid().price << " / " << book.best_ask().price << "\n";
+
+    // Same volume and no surplus at 100.00 and 101.00: the reference price decides
+    OrderBook tie;
+    tie.set_trade_handler([](const Trade&, void*) {}, nullptr);
+    tie.begin_auction();
+    tie.add_order(Order(1, true, 101.0, 100, get_timestamp_ns()));
+    tie.add_order(Order(2, false, 100.0, 100, get_timestamp_ns()));
+    double near_high = tie.indicative_uncross(100.8).price;
+    double no_reference = tie.indicative_uncross().price;
+    std::cout << " Tie:              " << near_high << " with reference 100.80, " << no_reference
+              << " without\n";
+    bool tie_ok = near_high == 101.0 && no_reference == 100.0;
+
+    std::cout << (call_ok && uncross_ok && tie_ok ? "✅ Auction accumulates and uncrosses at the right price\n"
+                                                  : "❌ Auction uncross is wrong\n");
 }
 
 // Main function
@@ -212,6 +1235,21 @@ int main(int argc, char* argv[]) {
         test_order_matching();
         test_fifo_priority();
         test_performance();
+        test_memory_pool_release();
+        test_incremental_snapshot();
+        test_l2_market_data();
+        test_mbo_feed_handler();
+        test_journal_recovery();
+        test_snapshot_recovery();
+        test_order_types();
+        test_iceberg_orders();
+        test_stop_orders();
+        test_gtt_orders();
+        test_self_trade_prevention();
+        test_post_only_and_price_band();
+        test_amend_priority();
+        test_matching_policies();
+        test_call_auction();
 
         std::cout << "\n╔══════════════════════════════════════════════════════════════╗\n";
         std::cout << "║                  ALL TESTS COMPLETED ✅                      ║\n";
@@ -0,0 +1,269 @@
+#include "market_data.h"
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// ============================================================================
+// MdRing: Create / Open / Destroy
+// ============================================================================
+MdRing::MdRing(std::string name, bool owner, size_t mapping_size, void* base)
+    : name_(std::move(name))
+    , owner_(owner)
+    , mapping_size_(mapping_size)
+    , header_(static_cast<Header*>(base))
+    , slots_(reinterpret_cast<Slot*>(static_cast<uint8_t*>(base) + sizeof(Header)))
+    , mask_(header_->capacity - 1) {
+}
+
+MdRing MdRing::create(const std::string& name, size_t capacity) {
+    size_t rounded = 1;
+    while (rounded < capacity) rounded <<= 1;
+
+    int fd = shm_open(name.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0600);
+    if (fd < 0) {
+        throw std::runtime_error("MdRing: shm_open(" + name + ") failed: " + std::strerror(errno));
+    }
+    size_t size = mapping_size(rounded);
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        int err = errno;
+        close(fd);
+        shm_unlink(name.c_str());
+        throw std::runtime_error("MdRing: ftruncate failed: " + std::string(std::strerror(err)));
+    }
+    void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        shm_unlink(name.c_str());
+        throw std::runtime_error("MdRing: mmap failed: " + std::string(std::strerror(errno)));
+    }
+
+    // Fresh pages are zeroed: every slot reads as "sequence 0", never valid
+    Header* header = new (base) Header();
+    header->magic = kMagic;
+    header->capacity = rounded;
+    header->write_seq.store(0, std::memory_order_release);
+    return MdRing(name, true, size, base);
+}
+
+MdRing MdRing::open(const std::string& name) {
+    int fd = shm_open(name.c_str(), O_RDWR, 0600);
+    if (fd < 0) {
+        throw std::runtime_error("MdRing: shm_open(" + name + ") failed: " + std::strerror(errno));
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(Header)) {
+        close(fd);
+        throw std::runtime_error("MdRing: " + name + " is not a market data ring");
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+    void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        throw std::runtime_error("MdRing: mmap failed: " + std::string(std::strerror(errno)));
+    }
+
+    const Header* header = static_cast<const Header*>(base);
+    if (header->magic != kMagic || mapping_size(header->capacity) != size) {
+        munmap(base, size);
+        throw std::runtime_error("MdRing: " + name + " has an unexpected layout");
+    }
+    return MdRing(name, false, size, base);
+}
+
+MdRing::MdRing(MdRing&& other) noexcept
+    : name_(std::move(other.name_))
+    , owner_(other.owner_)
+    , mapping_size_(other.mapping_size_)
+    , header_(other.header_)
+    , slots_(other.slots_)
+    , mask_(other.mask_) {
+    other.header_ = nullptr;
+    other.owner_ = false;
+}
+
+MdRing::~MdRing() {
+    if (!header_) return;
+    munmap(header_, mapping_size_);
+    if (owner_) {
+        shm_unlink(name_.c_str());
+    }
+}
+
+// ============================================================================
+// MarketDataPublisher
+// ============================================================================
+MarketDataPublisher::MarketDataPublisher(OrderBook& book, MdRing& ring, uint64_t refresh_interval)
+    : book_(book)
+    , ring_(ring)
+    , snapshot_(book, 0)
+    , refresh_interval_(refresh_interval)
+    , last_refresh_seq_(0)
+    , messages_published_(0) {
+    book_.set_trade_handler(&MarketDataPublisher::on_trade, this);
+    publish_full_refresh();
+}
+
+MarketDataPublisher::~MarketDataPublisher() {
+    book_.set_trade_handler(nullptr, nullptr);
+    book_.set_level_tracking(false);
+}
+
+void MarketDataPublisher::emit(MdMessageType type, MdSide side, double price,
+                               uint64_t quantity, uint32_t order_count) {
+    MdMessage msg{};
+    msg.type = type;
+    msg.side = side;
+    msg.order_count = order_count;
+    msg.price = price;
+    msg.quantity = quantity;
+    ring_.publish(msg);
+    messages_published_++;
+}
+
+void MarketDataPublisher::on_trade(const Trade& trade, void* context) {
+    auto* self = static_cast<MarketDataPublisher*>(context);
+    self->emit(MdMessageType::Trade, MdSide::None, trade.price, trade.quantity, 0);
+}
+
+size_t MarketDataPublisher::publish() {
+    uint64_t before = messages_published_;
+
+    snapshot_.collect_deltas(book_, deltas_);
+    for (const LevelUpdate& delta : deltas_) {
+        MdSide side = delta.is_bid ? MdSide::Bid : MdSide::Ask;
+        MdMessageType type = delta.order_count == 0 ? MdMessageType::LevelDelete
+                           : delta.is_new              ? MdMessageType::LevelNew
+                                                       : MdMessageType::LevelChange;
+        emit(type, side, delta.price, delta.total_quantity, delta.order_count);
+    }
+
+    if (refresh_interval_ > 0 && ring_.last_seq() - last_refresh_seq_ >= refresh_interval_) {
+        publish_full_refresh();
+    }
+    return static_cast<size_t>(messages_published_ - before);
+}
+
+void MarketDataPublisher::publish_full_refresh() {
+    // The refresh carries the current state of every level, so pending
+    // deltas are superseded
+    snapshot_.collect_deltas(book_, deltas_);
+    book_.get_snapshot(std::numeric_limits<size_t>::max(), refresh_bids_, refresh_asks_);
+
+    emit(MdMessageType::SnapshotBegin, MdSide::None, 0.0,
+         refresh_bids_.size() + refresh_asks_.size(), 0);
+    for (const PriceLevel& level : refresh_bids_) {
+        emit(MdMessageType::SnapshotLevel, MdSide::Bid, level.price,
+             level.total_quantity, level.order_count);
+    }
+    for (const PriceLevel& level : refresh_asks_) {
+        emit(MdMessageType::SnapshotLevel, MdSide::Ask, level.price,
+             level.total_quantity, level.order_count);
+    }
+    emit(MdMessageType::SnapshotEnd, MdSide::None, 0.0, 0, 0);
+    last_refresh_seq_ = ring_.last_seq();
+}
+
+// ============================================================================
+// L2BookRebuilder
+// ============================================================================
+L2BookRebuilder::L2BookRebuilder(const MdRing& ring, bool from_start)
+    : ring_(ring)
+    , next_seq_(from_start ? ring.oldest_seq() : ring.last_seq() + 1)
+    , synced_(false)
+    , in_refresh_(false)
+    , gaps_(0)
+    , trades_(0)
+    , traded_quantity_(0) {
+}
+
+size_t L2BookRebuilder::poll(size_t max_messages) {
+    size_t consumed = 0;
+    MdMessage msg;
+    while (consumed < max_messages) {
+        MdReadStatus status = ring_.read(next_seq_, msg);
+        if (status == MdReadStatus::NotReady) {
+            break;
+        }
+        if (status == MdReadStatus::Overrun) {
+            // Lost messages: resynchronize from the next full refresh
+            gaps_++;
+            synced_ = false;
+            in_refresh_ = false;
+            next_seq_ = ring_.oldest_seq();
+            continue;
+        }
+        apply(msg);
+        next_seq_++;
+        consumed++;
+    }
+    return consumed;
+}
+
+void L2BookRebuilder::apply(const MdMessage& msg) {
+    switch (msg.type) {
+        case MdMessageType::SnapshotBegin:
+            bids_.clear();
+            asks_.clear();
+            in_refresh_ = true;
+            break;
+        case MdMessageType::SnapshotLevel:
+            if (in_refresh_) {
+                apply_level(msg.side, msg.price, msg.quantity, msg.order_count);
+            }
+            break;
+        case MdMessageType::SnapshotEnd:
+            if (in_refresh_) {
+                in_refresh_ = false;
+                synced_ = true;
+            }
+            break;
+        case MdMessageType::LevelNew:
+        case MdMessageType::LevelChange:
+        case MdMessageType::LevelDelete:
+            if (synced_) {
+                apply_level(msg.side, msg.price, msg.quantity, msg.order_count);
+            }
+            break;
+        case MdMessageType::Trade:
+            if (synced_) {
+                trades_++;
+                traded_quantity_ += msg.quantity;
+            }
+            break;
+    }
+}
+
+void L2BookRebuilder::apply_level(MdSide side, double price, uint64_t quantity, uint32_t order_count) {
+    if (side == MdSide::Bid) {
+        if (order_count == 0) {
+            bids_.erase(price);
+        } else {
+            bids_[price] = LevelState{quantity, order_count};
+        }
+    } else if (side == MdSide::Ask) {
+        if (order_count == 0) {
+            asks_.erase(price);
+        } else {
+            asks_[price] = LevelState{quantity, order_count};
+        }
+    }
+}
+
+void L2BookRebuilder::get_snapshot(size_t depth, std::vector<PriceLevel>& bids,
+                                   std::vector<PriceLevel>& asks) const {
+    bids.clear();
+    asks.clear();
+
+    for (const auto& [price, level] : bids_) {
+        if (bids.size() >= depth) break;
+        bids.emplace_back(price, level.quantity, level.order_count);
+    }
+    for (const auto& [price, level] : asks_) {
+        if (asks.size() >= depth) break;
+        asks.emplace_back(price, level.quantity, level.order_count);
+    }
+}
@@ -0,0 +1,213 @@
+#pragma once
+
+#include "order_book.h"
+#include "depth_snapshot.h"
+#include <atomic>
+#include <string>
+
+// ============================================================================
+// L2 Market Data Message (32 bytes, little-endian, fixed size)
+// ============================================================================
+enum class MdMessageType : uint8_t {
+    LevelNew = 1,       // First order at a price
+    LevelChange = 2,    // Quantity or order count changed
+    LevelDelete = 3,    // Last order left the price
+    Trade = 4,          // Fill at price for quantity
+    SnapshotBegin = 5,  // Full refresh follows; quantity = number of levels
+    SnapshotLevel = 6,  // One level of the full refresh
+    SnapshotEnd = 7     // Full refresh complete
+};
+
+enum class MdSide : uint8_t {
+    None = 0,
+    Bid = 1,
+    Ask = 2
+};
+
+struct MdMessage {
+    uint64_t seq;          // Assigned by the ring, starts at 1, no gaps
+    MdMessageType type;
+    MdSide side;
+    uint16_t reserved;
+    uint32_t order_count;
+    double price;
+    uint64_t quantity;
+};
+static_assert(sizeof(MdMessage) == 32, "MdMessage must stay 32 bytes");
+
+// ============================================================================
+// Shared-Memory Broadcast Ring
+// ============================================================================
+// Single producer, any number of readers (in-process or other processes that
+// map the same name). The producer never waits for readers; each slot carries
+// a sequence stamp so a reader detects a slot that was overwritten under it.
+// Reading is plain loads from the mapping, no syscalls.
+enum class MdReadStatus {
+    Ok,
+    NotReady,  // Producer has not written this sequence yet
+    Overrun    // Sequence was overwritten; reader fell more than capacity behind
+};
+
+class MdRing {
+private:
+    struct Header {
+        uint64_t magic;
+        uint64_t capacity;
+        alignas(64) std::atomic<uint64_t> write_seq;  // Last published sequence
+    };
+
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> seq;  // Sequence held by the slot, 0 while written
+        MdMessage msg;
+    };
+
+    static constexpr uint64_t kMagic = 0x48465431324C3252ull;  // "HFT12L2R"
+
+    std::string name_;
+    bool owner_;
+    size_t mapping_size_;
+    Header* header_;
+    Slot* slots_;
+    uint64_t mask_;
+
+    static size_t mapping_size(size_t capacity) {
+        return sizeof(Header) + capacity * sizeof(Slot);
+    }
+
+public:
+    // Create (owner) or attach to a named ring under /dev/shm. Capacity is
+    // rounded up to a power of two. Throws std::runtime_error on failure.
+    static MdRing create(const std::string& name, size_t capacity);
+    static MdRing open(const std::string& name);
+
+    MdRing(MdRing&& other) noexcept;
+    ~MdRing();
+
+    MdRing(const MdRing&) = delete;
+    MdRing& operator=(const MdRing&) = delete;
+    MdRing& operator=(MdRing&&) = delete;
+
+    // Producer: stamps msg.seq and publishes it
+    void publish(MdMessage& msg) {
+        uint64_t seq = header_->write_seq.load(std::memory_order_relaxed) + 1;
+        msg.seq = seq;
+        Slot& slot = slots_[seq & mask_];
+        slot.seq.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.msg = msg;
+        slot.seq.store(seq, std::memory_order_release);
+        header_->write_seq.store(seq, std::memory_order_release);
+    }
+
+    // Reader: copy out message `seq`
+    MdReadStatus read(uint64_t seq, MdMessage& out) const {
+        const Slot& slot = slots_[seq & mask_];
+        uint64_t before = slot.seq.load(std::memory_order_acquire);
+        if (before != seq) {
+            return (before > seq || oldest_seq() > seq) ? MdReadStatus::Overrun
+                                                         : MdReadStatus::NotReady;
+        }
+        out = slot.msg;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.seq.load(std::memory_order_relaxed) != seq) {
+            return MdReadStatus::Overrun;
+        }
+        return MdReadStatus::Ok;
+    }
+
+    uint64_t last_seq() const { return header_->write_seq.load(std::memory_order_acquire); }
+    uint64_t oldest_seq() const {
+        uint64_t last = last_seq();
+        return last > mask_ ? last - mask_ : 1;
+    }
+    size_t capacity() const { return static_cast<size_t>(mask_ + 1); }
+    const std::string& name() const { return name_; }
+
+private:
+    MdRing(std::string name, bool owner, size_t mapping_size, void* base);
+};
+
+// ============================================================================
+// L2 Market Data Publisher
+// ============================================================================
+// Turns OrderBook level changes and trades into MdMessages on an MdRing.
+// Trades go out as they execute; level changes are collected from the book's
+// dirty-level queue when publish() is called (once per processed input), so
+// several changes to one level within an input are conflated into one
+// message. A full refresh is emitted on construction and then every
+// `refresh_interval` messages so late joiners can synchronize.
+class MarketDataPublisher {
+private:
+    OrderBook& book_;
+    MdRing& ring_;
+    DepthSnapshot snapshot_;
+    std::vector<LevelUpdate> deltas_;
+    std::vector<PriceLevel> refresh_bids_;
+    std::vector<PriceLevel> refresh_asks_;
+    uint64_t refresh_interval_;
+    uint64_t last_refresh_seq_;
+    uint64_t messages_published_;
+
+    static void on_trade(const Trade& trade, void* context);
+    void emit(MdMessageType type, MdSide side, double price,
+              uint64_t quantity, uint32_t order_count);
+
+public:
+    MarketDataPublisher(OrderBook& book, MdRing& ring, uint64_t refresh_interval = 4096);
+    ~MarketDataPublisher();
+
+    MarketDataPublisher(const MarketDataPublisher&) = delete;
+    MarketDataPublisher& operator=(const MarketDataPublisher&) = delete;
+
+    // Publish level changes since the last call; returns messages written
+    size_t publish();
+
+    // Publish every level of the book as one refresh
+    void publish_full_refresh();
+
+    uint64_t messages_published() const { return messages_published_; }
+};
+
+// ============================================================================
+// L2 Book Rebuilder (consumer side)
+// ============================================================================
+// Rebuilds aggregated levels from an MdRing. Starts unsynchronized, waits for
+// the next full refresh, then applies incrementals. A sequence gap (overrun)
+// drops back to waiting for a refresh.
+class L2BookRebuilder {
+private:
+    struct LevelState {
+        uint64_t quantity;
+        uint32_t order_count;
+    };
+
+    const MdRing& ring_;
+    uint64_t next_seq_;
+    bool synced_;
+    bool in_refresh_;
+    uint64_t gaps_;
+    uint64_t trades_;
+    uint64_t traded_quantity_;
+
+    std::map<double, LevelState, std::greater<double>> bids_;
+    std::map<double, LevelState, std::less<double>> asks_;
+
+    void apply(const MdMessage& msg);
+    void apply_level(MdSide side, double price, uint64_t quantity, uint32_t order_count);
+
+public:
+    // from_start: read from the oldest retained message instead of the head
+    explicit L2BookRebuilder(const MdRing& ring, bool from_start = false);
+
+    // Consume up to max_messages available messages; returns number consumed
+    size_t poll(size_t max_messages = std::numeric_limits<size_t>::max());
+
+    void get_snapshot(size_t depth, std::vector<PriceLevel>& bids,
+                      std::vector<PriceLevel>& asks) const;
+    bool synced() const { return synced_; }
+    uint64_t gaps() const { return gaps_; }
+    uint64_t trades() const { return trades_; }
+    uint64_t traded_quantity() const { return traded_quantity_; }
+    size_t bid_levels() const { return bids_.size(); }
+    size_t ask_levels() const { return asks_.size(); }
+};
@@ -0,0 +1,216 @@
+#include "mbo_feed.h"
+#include <cstdio>
+#include <random>
+#include <stdexcept>
+
+// ============================================================================
+// Constructor
+// ============================================================================
+MboFeedHandler::MboFeedHandler(OrderBook& book)
+    : book_(book)
+    , next_seq_(1)
+    , state_(State::Live)
+    , stats_{0, 0, 0, 0, 0} {
+    // A matching book would trade crossing adds itself and drift from the
+    // venue, which has already matched them
+    if (book.mode() != BookMode::Passive) {
+        throw std::invalid_argument("MboFeedHandler: the book must be in BookMode::Passive");
+    }
+}
+
+// ============================================================================
+// On Message (sequence check)
+// ============================================================================
+bool MboFeedHandler::on_message(const MboMessage& msg) {
+    if (msg.seq < next_seq_) {
+        stats_.duplicates++;
+        return false;
+    }
+
+    if (state_ == State::Recovering) {
+        buffered_.push_back(msg);
+        return false;
+    }
+
+    if (msg.seq != next_seq_) {
+        // Gap: everything from here on waits for a snapshot
+        stats_.gaps++;
+        state_ = State::Recovering;
+        buffered_.push_back(msg);
+        return false;
+    }
+
+    apply(msg);
+    next_seq_++;
+    return true;
+}
+
+// ============================================================================
+// Apply (book mutation)
+// ============================================================================
+void MboFeedHandler::apply(const MboMessage& msg) {
+    stats_.messages_applied++;
+
+    switch (msg.type) {
+        case MboMessageType::Add:
+            book_.add_order(Order(msg.order_id, msg.is_buy != 0, msg.price, msg.quantity, msg.seq));
+            break;
+
+        case MboMessageType::Modify:
+            if (!book_.amend_order(msg.order_id, msg.price, msg.quantity)) {
+                stats_.unknown_orders++;
+            }
+            break;
+
+        case MboMessageType::Delete:
+            if (!book_.cancel_order(msg.order_id)) {
+                stats_.unknown_orders++;
+            }
+            break;
+
+        case MboMessageType::Execute:
+            if (!book_.execute_order(msg.order_id, msg.quantity)) {
+                stats_.unknown_orders++;
+            }
+            break;
+    }
+}
+
+// ============================================================================
+// Apply Snapshot (gap recovery)
+// ============================================================================
+void MboFeedHandler::apply_snapshot(const MboSnapshot& snapshot) {
+    book_.clear();
+    for (const Order& order : snapshot.orders) {
+        book_.add_order(order);
+    }
+    next_seq_ = snapshot.seq + 1;
+    state_ = State::Live;
+    stats_.recoveries++;
+
+    // Replay what arrived during recovery; stop again at a further gap
+    std::vector<MboMessage> pending;
+    pending.swap(buffered_);
+    for (size_t i = 0; i < pending.size(); ++i) {
+        if (state_ == State::Recovering) {
+            buffered_.push_back(pending[i]);
+        } else {
+            on_message(pending[i]);
+        }
+    }
+}
+
+// ============================================================================
+// Take Snapshot
+// ============================================================================
+void take_mbo_snapshot(const OrderBook& book, uint64_t seq, MboSnapshot& snapshot) {
+    snapshot.seq = seq;
+    snapshot.orders.clear();
+    book.for_each_order([&](const Order& order) {
+        snapshot.orders.push_back(order);
+    });
+}
+
+// ============================================================================
+// Synthetic venue stream
+// ============================================================================
+void generate_mbo_stream(size_t num_messages, uint32_t seed, std::vector<MboMessage>& out) {
+    struct LiveOrder {
+        uint64_t order_id;
+        bool is_buy;
+        int64_t ticks;      // Distance from the mid in 0.01 ticks (>= 1)
+        uint64_t quantity;
+    };
+
+    const double mid = 100.0;
+    const double tick = 0.01;
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<int> action_dist(0, 99);
+    std::uniform_int_distribution<int64_t> tick_dist(1, 50);
+    std::uniform_int_distribution<uint64_t> qty_dist(1, 1000);
+
+    // Keep the book near a steady size, like a venue over a session
+    const size_t max_live = 10000;
+    std::vector<LiveOrder> live;
+    uint64_t next_id = 1;
+
+    out.clear();
+    out.reserve(num_messages);
+    for (uint64_t seq = 1; seq <= num_messages; ++seq) {
+        MboMessage msg{};
+        msg.seq = seq;
+        int action = action_dist(gen);
+
+        if ((action < 50 && live.size() < max_live) || live.size() < 100) {
+            LiveOrder order{next_id++, (gen() & 1) == 0, tick_dist(gen), qty_dist(gen)};
+            live.push_back(order);
+            msg.type = MboMessageType::Add;
+            msg.order_id = order.order_id;
+            msg.is_buy = order.is_buy ? 1 : 0;
+            msg.price = order.is_buy ? mid - static_cast<double>(order.ticks) * tick
+                                     : mid + static_cast<double>(order.ticks) * tick;
+            msg.quantity = order.quantity;
+        } else {
+            size_t idx = static_cast<size_t>(gen() % live.size());
+            LiveOrder& order = live[idx];
+            msg.order_id = order.order_id;
+            msg.is_buy = order.is_buy ? 1 : 0;
+
+            bool remove = false;
+            if (action < 70) {
+                msg.type = MboMessageType::Delete;
+                remove = true;
+            } else if (action < 85) {
+                msg.type = MboMessageType::Modify;
+                if (action < 78) {
+                    order.ticks = tick_dist(gen);
+                }
+                order.quantity = qty_dist(gen);
+                msg.quantity = order.quantity;
+            } else {
+                msg.type = MboMessageType::Execute;
+                msg.quantity = std::min(order.quantity, qty_dist(gen));
+                order.quantity -= msg.quantity;
+                remove = order.quantity == 0;
+            }
+            msg.price = order.is_buy ? mid - static_cast<double>(order.ticks) * tick
+                                     : mid + static_cast<double>(order.ticks) * tick;
+
+            if (remove) {
+                live[idx] = live.back();
+                live.pop_back();
+            }
+        }
+        out.push_back(msg);
+    }
+}
+
+// ============================================================================
+// Recorded stream files
+// ============================================================================
+bool write_mbo_file(const std::string& path, const std::vector<MboMessage>& messages) {
+    FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) {
+        return false;
+    }
+    size_t written = std::fwrite(messages.data(), sizeof(MboMessage), messages.size(), f);
+    return std::fclose(f) == 0 && written == messages.size();
+}
+
+bool read_mbo_file(const std::string& path, std::vector<MboMessage>& messages) {
+    FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) {
+        return false;
+    }
+    std::fseek(f, 0, SEEK_END);
+    long size = std::ftell(f);
+    std::fseek(f, 0, SEEK_SET);
+    if (size < 0 || static_cast<size_t>(size) % sizeof(MboMessage) != 0) {
+        std::fclose(f);
+        return false;
+    }
+    messages.resize(static_cast<size_t>(size) / sizeof(MboMessage));
+    size_t read = std::fread(messages.data(), sizeof(MboMessage), messages.size(), f);
+    std::fclose(f);
+    return read == messages.size();
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "order_book.h"
+#include <string>
+
+// ============================================================================
+// Market-By-Order (L3) Message (40 bytes, fixed size)
+// ============================================================================
+enum class MboMessageType : uint8_t {
+    Add = 1,      // New resting order
+    Modify = 2,   // New price and/or quantity for an existing order
+    Delete = 3,   // Order removed (cancelled by its owner)
+    Execute = 4   // Venue-reported fill of `quantity` against a resting order
+};
+
+struct MboMessage {
+    uint64_t seq;          // Per-channel sequence, starts at 1, no gaps
+    uint64_t order_id;
+    double price;
+    uint64_t quantity;
+    MboMessageType type;
+    uint8_t is_buy;
+    uint8_t reserved[6];
+};
+static_assert(sizeof(MboMessage) == 40, "MboMessage must stay 40 bytes");
+
+// Point-in-time image of a venue book, used to recover from a gap. Orders
+// are in FIFO order per level; `seq` is the last message reflected in it.
+struct MboSnapshot {
+    uint64_t seq;
+    std::vector<Order> orders;
+};
+
+// ============================================================================
+// MBO Feed Handler
+// ============================================================================
+// Applies an exchange MBO stream to an OrderBook in BookMode::Passive. The
+// venue already matched, so the book only mirrors levels and orders; the
+// constructor throws std::invalid_argument for a book in any other mode.
+//
+// Sequence handling: duplicates (seq below the next expected) are dropped.
+// A gap moves the handler to Recovering: later messages are buffered and
+// the caller must supply a snapshot via apply_snapshot(). Buffered messages
+// newer than the snapshot are then replayed, and live processing resumes.
+class MboFeedHandler {
+public:
+    enum class State : uint8_t {
+        Live,
+        Recovering
+    };
+
+    struct Stats {
+        uint64_t messages_applied;
+        uint64_t duplicates;
+        uint64_t gaps;
+        uint64_t unknown_orders;   // Modify/Delete/Execute for an unknown id
+        uint64_t recoveries;
+    };
+
+private:
+    OrderBook& book_;
+    uint64_t next_seq_;
+    State state_;
+    std::vector<MboMessage> buffered_;
+    Stats stats_;
+
+    void apply(const MboMessage& msg);
+
+public:
+    explicit MboFeedHandler(OrderBook& book);
+
+    // Process one message from the wire; returns false if it was not
+    // applied (duplicate, or buffered while recovering)
+    bool on_message(const MboMessage& msg);
+
+    // Rebuild the book from a snapshot and replay buffered messages
+    void apply_snapshot(const MboSnapshot& snapshot);
+
+    State state() const { return state_; }
+    bool needs_recovery() const { return state_ == State::Recovering; }
+    uint64_t next_seq() const { return next_seq_; }
+    const Stats& stats() const { return stats_; }
+};
+
+// Capture an MboSnapshot of a passive book that mirrors the venue
+void take_mbo_snapshot(const OrderBook& book, uint64_t seq, MboSnapshot& snapshot);
+
+// ============================================================================
+// Synthetic venue stream
+// ============================================================================
+// Deterministic exchange-style MBO stream (adds, modifies, deletes and
+// executes against a non-crossed book) for tests and benchmarks.
+void generate_mbo_stream(size_t num_messages, uint32_t seed, std::vector<MboMessage>& out);
+
+// Recorded stream files are a raw array of MboMessage
+bool write_mbo_file(const std::string& path, const std::vector<MboMessage>& messages);
+bool read_mbo_file(const std::string& path, std::vector<MboMessage>& messages);
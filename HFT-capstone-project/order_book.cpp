@@ -5,155 +5,737 @@
 // ============================================================================
 // Constructor & Destructor
 // ============================================================================
-OrderBook::OrderBook() 
-    : total_orders_added_(0)
+template<typename Policy>
+BasicOrderBook<Policy>::BasicOrderBook(BookMode mode) 
+    : best_bid_{-std::numeric_limits<double>::infinity(), 0, 0}
+    , best_ask_{std::numeric_limits<double>::infinity(), 0, 0}
+    , level_version_(0)
+    , track_level_changes_(false)
+    , mode_(mode)
+    , trade_handler_(nullptr)
+    , trade_context_(nullptr)
+    , total_orders_added_(0)
     , total_orders_cancelled_(0)
-    , total_orders_matched_(0) {
+    , total_orders_matched_(0)
+    , trade_low_(std::numeric_limits<double>::infinity())
+    , trade_high_(-std::numeric_limits<double>::infinity())
+    , price_band_(std::numeric_limits<double>::infinity())
+    , ticks_per_unit_(1.0 / stops_.tick_size())
+    , auction_(false)
+    , clock_ns_(0)
+    , expiry_resolution_ns_(1000) {
 }
 
-OrderBook::~OrderBook() {
+template<typename Policy>
+BasicOrderBook<Policy>::~BasicOrderBook() {
     clear();
 }
 
 // ============================================================================
 // Add Order
 // ============================================================================
-void OrderBook::add_order(const Order& order) {
-    // Allocate order from memory pool
-    Order* new_order = order_pool_.allocate();
-    *new_order = order;
+template<typename Policy>
+void BasicOrderBook<Policy>::add_order(const Order& order) {
+    trade_low_ = std::numeric_limits<double>::infinity();
+    trade_high_ = -std::numeric_limits<double>::infinity();
+    place_order(order);
+    if (!stops_.empty()) {
+        trigger_stops();
+    }
+}
 
-    total_orders_added_++;
+template<typename Policy>
+void BasicOrderBook<Policy>::place_order(const Order& order) {
+    HFT_LATENCY_SCOPE(latency, add_passive);
 
-    if (order.is_buy) {
-        // Add to bids
-        auto it = bids_.find(order.price);
-        if (it == bids_.end()) {
-            // Create new price level
-            auto result = bids_.emplace(std::piecewise_construct,
-                                       std::forward_as_tuple(order.price),
-                                       std::forward_as_tuple(order.price));
-            it = result.first;
+    total_orders_added_++;
+    uint64_t remaining = order.quantity;
+    double price = order.price;
+
+    if (mode_ == BookMode::Matching && auction_) {
+        // Call phase: the order rests even if it crosses, so only a limit
+        // GTC or unexpired GTT can wait for the uncross
+        bool can_wait = order.type == OrderType::Limit &&
+                        (order.tif == TimeInForce::Gtc ||
+                         (order.tif == TimeInForce::Gtt && order.expire_ns > clock_ns_));
+        if (!can_wait) {
+            HFT_LATENCY_RETARGET(latency, add_rejected);
+            total_orders_cancelled_++;
+            return;
+        }
+    } else if (mode_ == BookMode::Matching) {
+        if (order.tif == TimeInForce::Gtt && order.expire_ns <= clock_ns_) {
+            total_orders_cancelled_++;  // Expired on arrival
+            return;
         }
 
-        // Add order to the end of the list (FIFO)
-        it->second.orders.push_back(new_order);
-        it->second.total_quantity += order.quantity;
-
-        // Store location for fast lookup
-        OrderLocation loc;
-        loc.order = new_order;
-        loc.list_iter = --it->second.orders.end();
-        loc.is_bid = true;
-        loc.price = order.price;
-        order_lookup_[order.order_id] = loc;
+        // Every arrival check below reads only the cached top of book, so a
+        // rejected order costs a few compares: no allocation, no tree or
+        // lookup access. The band edge is infinite while the band is off or
+        // the opposite side is empty, and market orders trade up to it.
+        double best_opposite = order.is_buy ? best_ask_.price : best_bid_.price;
+        double band_edge = order.is_buy ? best_opposite + price_band_ : best_opposite - price_band_;
+        double limit = order.type == OrderType::Market ? band_edge : order.price;
+        if (order.is_buy ? limit > band_edge : limit < band_edge) {
+            HFT_LATENCY_RETARGET(latency, add_rejected);
+            total_orders_cancelled_++;  // Outside the price band
+            return;
+        }
 
-    } else {
-        // Add to asks
-        auto it = asks_.find(order.price);
-        if (it == asks_.end()) {
-            // Create new price level
-            auto result = asks_.emplace(std::piecewise_construct,
-                                       std::forward_as_tuple(order.price),
-                                       std::forward_as_tuple(order.price));
-            it = result.first;
+        // Only a crossing order can trade; passive orders skip the matcher.
+        // The aggressor is matched from the caller's copy, so a fill never
+        // allocates, creates a level or touches the lookup.
+        bool crosses = order.is_buy ? limit >= best_opposite : limit <= best_opposite;
+        if (crosses && order.type >= OrderType::PostOnly) {
+            if (order.type == OrderType::PostOnly) {
+                HFT_LATENCY_RETARGET(latency, add_rejected);
+                total_orders_cancelled_++;  // Would have taken liquidity
+                return;
+            }
+            // Slide to one tick inside the best opposite price
+            int64_t ticks = std::llround(best_opposite * ticks_per_unit_) + (order.is_buy ? -1 : 1);
+            price = static_cast<double>(ticks) / ticks_per_unit_;
+            crosses = false;
+        }
+        if (crosses) {
+            HFT_LATENCY_RETARGET(latency, add_crossing);
+            if (order.tif == TimeInForce::Fok &&
+                !(order.is_buy ? can_fill(asks_, order, limit) : can_fill(bids_, order, limit))) {
+                total_orders_cancelled_++;  // Killed: not enough crossing depth
+                return;
+            }
+            remaining = order.is_buy ? sweep(asks_, order, limit) : sweep(bids_, order, limit);
         }
 
-        // Add order to the end of the list (FIFO)
-        it->second.orders.push_back(new_order);
-        it->second.total_quantity += order.quantity;
+        if (remaining > 0 && (order.type == OrderType::Market || order.tif == TimeInForce::Ioc ||
+                              order.tif == TimeInForce::Fok)) {
+            total_orders_cancelled_++;  // Unfilled remainder is not allowed to rest
+            return;
+        }
+        if (remaining == 0) {
+            return;
+        }
+    }
 
-        // Store location for fast lookup
-        OrderLocation loc;
-        loc.order = new_order;
-        loc.list_iter = --it->second.orders.end();
-        loc.is_bid = false;
-        loc.price = order.price;
-        order_lookup_[order.order_id] = loc;
+    // Allocate order from memory pool; an iceberg shows its first slice
+    PoolHandle handle = order_pool_.allocate();
+    Order& resting = order_pool_[handle].order;
+    resting = order;
+    resting.price = price;
+    order_pool_[handle].timer = kInvalidHandle;
+    if (order.tif == TimeInForce::Gtt && mode_ == BookMode::Matching) {
+        order_pool_[handle].timer = expiries_.arm(expiry_tick(order.expire_ns), handle);
     }
+    resting.hidden_quantity = 0;
+    if (order.is_iceberg() && remaining > order.display_quantity) {
+        resting.hidden_quantity = remaining - order.display_quantity;
+        remaining = order.display_quantity;
+    } else {
+        resting.display_quantity = 0;  // Fits in one slice: a plain order
+    }
+    resting.quantity = remaining;
+
+    join_level(handle);
 
-    // Attempt to match orders
-    match_orders();
+    // Store handle for fast lookup
+    order_lookup_[order.order_id] = handle;
 }
 
 // ============================================================================
 // Cancel Order
 // ============================================================================
-bool OrderBook::cancel_order(uint64_t order_id) {
+template<typename Policy>
+bool BasicOrderBook<Policy>::cancel_order(uint64_t order_id) {
+    HFT_LATENCY_SCOPE(latency, cancel);
+
     auto lookup_it = order_lookup_.find(order_id);
     if (lookup_it == order_lookup_.end()) {
+        if (stops_.cancel(order_id)) {
+            total_orders_cancelled_++;  // A pending stop
+            return true;
+        }
         return false;  // Order not found
     }
 
-    const OrderLocation& loc = lookup_it->second;
-    remove_order_from_book(loc);
-    
+    PoolHandle handle = lookup_it->second;
     order_lookup_.erase(lookup_it);
+    remove_order_from_book(handle);
+    
     total_orders_cancelled_++;
 
     return true;
 }
 
+// ============================================================================
+// Stop Orders
+// ============================================================================
+template<typename Policy>
+bool BasicOrderBook<Policy>::add_stop_order(const Order& order, double trigger_price) {
+    if (mode_ != BookMode::Matching || order_lookup_.count(order.order_id) != 0) {
+        return false;
+    }
+    return stops_.add(order, trigger_price);
+}
+
+// Inject the stops triggered by the trades of the last add. Their own
+// trades can trigger further stops, so repeat until a round prints
+// nothing new.
+template<typename Policy>
+void BasicOrderBook<Policy>::trigger_stops() {
+    while (trade_low_ <= trade_high_ && stops_.triggers(trade_low_, trade_high_)) {
+        triggered_.clear();
+        stops_.collect(trade_low_, trade_high_, triggered_);
+        trade_low_ = std::numeric_limits<double>::infinity();
+        trade_high_ = -std::numeric_limits<double>::infinity();
+        for (const Order& order : triggered_) {
+            place_order(order);
+        }
+    }
+}
+
+template<typename Policy>
+bool BasicOrderBook<Policy>::set_tick_size(double tick_size) {
+    if (!stops_.set_tick_size(tick_size)) {
+        return false;
+    }
+    ticks_per_unit_ = 1.0 / tick_size;  // Dividing by it round-trips decimal prices
+    return true;
+}
+
+// ============================================================================
+// Price Band
+// ============================================================================
+template<typename Policy>
+bool BasicOrderBook<Policy>::set_price_band(double width) {
+    if (!(width > 0.0)) {
+        return false;
+    }
+    price_band_ = width;
+    return true;
+}
+
+// ============================================================================
+// Call Auction
+// ============================================================================
+template<typename Policy>
+bool BasicOrderBook<Policy>::begin_auction() {
+    if (mode_ != BookMode::Matching || auction_) {
+        return false;
+    }
+    auction_ = true;
+    return true;
+}
+
+// Candidate prices are the level prices in [best ask, best bid], visited
+// in ascending order by merging the crossed bids (walked from the lowest
+// up) with the crossed asks. Supply at a candidate is a running sum of the
+// asks behind it; demand starts as the whole crossed bid quantity and
+// drops each bid level once passed. The tie-break needs only the lowest,
+// highest and nearest-reference candidates of the current best set and
+// which side its surplus has been on, so nothing is stored per level.
+template<typename Policy>
+AuctionResult BasicOrderBook<Policy>::indicative_uncross(double reference_price) const {
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    if (best_bid_.price < best_ask_.price) {
+        return {nan, 0, 0, 0};  // Nothing crosses
+    }
+
+    auto crossed_bids = bids_.upper_bound(best_ask_.price);  // Bids below the best ask
+    uint64_t demand = 0;
+    for (auto it = bids_.begin(); it != crossed_bids; ++it) {
+        demand += it->second.total_quantity + it->second.hidden_quantity;
+    }
+    uint64_t supply = 0;
+    auto bid_it = std::make_reverse_iterator(crossed_bids);
+    auto ask_it = asks_.begin();
+    auto ask_end = asks_.upper_bound(best_bid_.price);
+
+    AuctionResult low{nan, 0, 0, 0};
+    AuctionResult high = low;
+    AuctionResult nearest = low;
+    uint64_t best_surplus = 0;
+    double nearest_distance = 0.0;
+    bool buy_surplus = false;   // At every tied price
+    bool sell_surplus = false;
+    while (bid_it != bids_.rend() || ask_it != ask_end) {
+        double price = bid_it == bids_.rend() ? ask_it->first
+                     : ask_it == ask_end      ? bid_it->first
+                                              : std::min(bid_it->first, ask_it->first);
+        if (ask_it != ask_end && ask_it->first == price) {
+            supply += ask_it->second.total_quantity + ask_it->second.hidden_quantity;
+            ++ask_it;
+        }
+        AuctionResult candidate{price, std::min(demand, supply), demand, supply};
+        if (bid_it != bids_.rend() && bid_it->first == price) {
+            demand -= bid_it->second.total_quantity + bid_it->second.hidden_quantity;
+            ++bid_it;
+        }
+
+        bool buy_side = candidate.buy_quantity > candidate.sell_quantity;
+        bool sell_side = candidate.sell_quantity > candidate.buy_quantity;
+        uint64_t surplus = buy_side ? candidate.buy_quantity - candidate.sell_quantity
+                                    : candidate.sell_quantity - candidate.buy_quantity;
+        double distance = std::fabs(price - reference_price);
+        if (candidate.volume > low.volume ||
+            (candidate.volume == low.volume && surplus < best_surplus)) {
+            low = high = nearest = candidate;
+            best_surplus = surplus;
+            nearest_distance = distance;
+            buy_surplus = buy_side;
+            sell_surplus = sell_side;
+        } else if (candidate.volume == low.volume && surplus == best_surplus) {
+            high = candidate;
+            buy_surplus = buy_surplus && buy_side;
+            sell_surplus = sell_surplus && sell_side;
+            if (distance < nearest_distance) {  // Never true without a reference
+                nearest = candidate;
+                nearest_distance = distance;
+            }
+        }
+    }
+    return buy_surplus ? high : sell_surplus ? low : nearest;
+}
+
+template<typename Policy>
+AuctionResult BasicOrderBook<Policy>::uncross(double reference_price) {
+    AuctionResult result = indicative_uncross(reference_price);
+    auction_ = false;
+    if (result.volume == 0) {
+        return result;
+    }
+
+    auction_buys_.clear();
+    auction_sells_.clear();
+    consumed_.clear();
+    fill_auction_side(bids_, true, result.volume, auction_buys_);
+    fill_auction_side(asks_, false, result.volume, auction_sells_);
+    release_auction_fills();
+
+    // Both sides filled exactly `volume`: pair them off in priority order.
+    // The book is settled, so trades go out in batches as they are paired
+    // rather than through one fills_ the size of the auction.
+    constexpr size_t kReportBatch = 1024;
+    trade_low_ = std::numeric_limits<double>::infinity();
+    trade_high_ = -std::numeric_limits<double>::infinity();
+    fills_.clear();
+    size_t buy = 0;
+    size_t sell = 0;
+    uint64_t buy_left = auction_buys_[0].quantity;
+    uint64_t sell_left = auction_sells_[0].quantity;
+    while (buy < auction_buys_.size() && sell < auction_sells_.size()) {
+        uint64_t quantity = std::min(buy_left, sell_left);
+        fills_.push_back(Trade{auction_buys_[buy].order_id, auction_sells_[sell].order_id,
+                               result.price, quantity});
+        buy_left -= quantity;
+        sell_left -= quantity;
+        if (buy_left == 0 && ++buy < auction_buys_.size()) {
+            buy_left = auction_buys_[buy].quantity;
+        }
+        if (sell_left == 0 && ++sell < auction_sells_.size()) {
+            sell_left = auction_sells_[sell].quantity;
+        }
+        if (fills_.size() == kReportBatch) {
+            report_trades();
+            fills_.clear();
+        }
+    }
+    report_trades();
+    if (!stops_.empty()) {
+        trigger_stops();
+    }
+    return result;
+}
+
+// Fill `volume` from one side, best level first and FIFO within a level,
+// whatever the level prices: every order reached is within the clearing
+// price. The levels taken whole are found from their aggregates first.
+// Each step through a queue is a cache miss on a pool node, so their
+// queues are walked kChains at a time, round robin, writing each level's
+// fills to its own slots: independent chains overlap their misses (about
+// 6x faster at 1M orders than one queue after another). At most one more
+// level is part-filled; its last order reached can be left part-filled,
+// an iceberg giving its displayed size first, then its reserve, and
+// re-slicing to the back as in a sweep. Emptied levels are erased as one
+// prefix; fully filled orders are appended to consumed_ for
+// release_auction_fills().
+template<typename Policy>
+template<typename Levels>
+void BasicOrderBook<Policy>::fill_auction_side(Levels& levels, bool is_bid, uint64_t volume,
+                                               std::vector<AuctionFill>& fills) {
+    auto whole_end = levels.begin();
+    size_t whole_orders = 0;
+    for (; whole_end != levels.end(); ++whole_end) {
+        uint64_t size = whole_end->second.total_quantity + whole_end->second.hidden_quantity;
+        if (size > volume) {
+            break;
+        }
+        volume -= size;
+        whole_orders += whole_end->second.order_count;
+    }
+
+    constexpr size_t kChains = 8;
+    struct Chain {
+        PoolHandle handle;
+        size_t slot;
+    };
+    Chain chains[kChains];
+    size_t fill_base = fills.size();
+    size_t consumed_base = consumed_.size();
+    fills.resize(fill_base + whole_orders);
+    consumed_.resize(consumed_base + whole_orders);
+    auto next_level = levels.begin();
+    size_t next_slot = 0;
+    auto start_chain = [&](Chain& chain) {
+        PriceLevelData& level = next_level->second;
+        touch_level(level, is_bid);
+        chain = {level.head, next_slot};
+        next_slot += level.order_count;
+        ++next_level;
+    };
+    size_t active = 0;
+    while (active < kChains && next_level != whole_end) {
+        start_chain(chains[active++]);
+    }
+    while (active > 0) {
+        for (size_t i = 0; i < active;) {
+            Chain& chain = chains[i];
+            const OrderNode& node = order_pool_[chain.handle];
+            fills[fill_base + chain.slot] = {node.order.order_id,
+                                             node.order.quantity + node.order.hidden_quantity};
+            consumed_[consumed_base + chain.slot] = chain.handle;
+            chain.slot++;
+            chain.handle = node.next;
+            if (chain.handle == kInvalidHandle) {
+                if (next_level == whole_end) {
+                    chain = chains[--active];  // No level left to start
+                    continue;
+                }
+                start_chain(chain);
+            }
+            ++i;
+        }
+    }
+
+    if (volume > 0) {
+        // The level is bigger than what is left, so it survives
+        PriceLevelData& level = whole_end->second;
+        touch_level(level, is_bid);
+        PoolHandle handle = level.head;
+        bool requeue = false;
+        while (volume > 0) {
+            Order& resting = order_pool_[handle].order;
+            uint64_t size = resting.quantity + resting.hidden_quantity;
+            uint64_t quantity = std::min(volume, size);
+            fills.push_back({resting.order_id, quantity});
+            volume -= quantity;
+            if (quantity < size) {
+                if (quantity < resting.quantity) {
+                    resting.quantity -= quantity;
+                    level.total_quantity -= quantity;
+                } else {
+                    uint64_t reserve = quantity - resting.quantity;
+                    level.total_quantity -= resting.quantity;
+                    level.hidden_quantity -= reserve;
+                    resting.hidden_quantity -= reserve;
+                    resting.quantity = 0;
+                    requeue = true;
+                }
+                break;
+            }
+            level.total_quantity -= resting.quantity;
+            level.hidden_quantity -= resting.hidden_quantity;
+            consumed_.push_back(handle);
+            level.order_count--;
+            handle = order_pool_[handle].next;
+            level.head = handle;
+        }
+
+        if constexpr (Policy::kTopOrder) {
+            // The top order keeps its status only while it rests at the
+            // head, untouched or part-filled
+            if (level.top != handle || requeue) {
+                level.top = kInvalidHandle;
+            }
+        }
+        order_pool_[handle].prev = kInvalidHandle;
+        if (requeue) {
+            replenish(level, handle);
+        }
+    }
+
+    levels.erase(levels.begin(), whole_end);
+    if (is_bid) {
+        refresh_best_bid();
+    } else {
+        refresh_best_ask();
+    }
+}
+
+// Release the orders an uncross filled. Erasing a lookup entry by key
+// misses cache at every step once the book is large (~0.5 us each at 1M
+// orders), and an opening uncross can fill half the book. From 1/16 of
+// the lookup on, one pass over the whole map against a byte per pool
+// handle is cheaper: it walks the map's nodes in order.
+template<typename Policy>
+void BasicOrderBook<Policy>::release_auction_fills() {
+    if (consumed_.size() * 16 < order_lookup_.size()) {
+        for (PoolHandle handle : consumed_) {
+            order_lookup_.erase(order_pool_[handle].order.order_id);
+        }
+    } else {
+        PoolHandle last = *std::max_element(consumed_.begin(), consumed_.end());
+        auction_marks_.assign(static_cast<size_t>(last) + 1, 0);
+        for (PoolHandle handle : consumed_) {
+            auction_marks_[handle] = 1;
+        }
+        for (auto it = order_lookup_.begin(); it != order_lookup_.end();) {
+            if (it->second <= last && auction_marks_[it->second] != 0) {
+                it = order_lookup_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    for (PoolHandle handle : consumed_) {
+        if (order_pool_[handle].timer != kInvalidHandle) {
+            expiries_.cancel(order_pool_[handle].timer);
+        }
+        order_pool_.deallocate(handle);
+    }
+}
+
+// ============================================================================
+// GTT Expiry
+// ============================================================================
+template<typename Policy>
+size_t BasicOrderBook<Policy>::advance_time(uint64_t now_ns) {
+    if (now_ns <= clock_ns_) {
+        return 0;
+    }
+    clock_ns_ = now_ns;
+
+    expired_.clear();
+    expiries_.advance(now_ns / expiry_resolution_ns_, expired_);
+    for (uint64_t payload : expired_) {
+        // The wheel has already released the timer
+        OrderNode& node = order_pool_[static_cast<PoolHandle>(payload)];
+        node.timer = kInvalidHandle;
+        cancel_order(node.order.order_id);
+    }
+    return expired_.size();
+}
+
+template<typename Policy>
+bool BasicOrderBook<Policy>::set_expiry_resolution(uint64_t resolution_ns) {
+    if (!expiries_.empty() || resolution_ns == 0) {
+        return false;
+    }
+    expiry_resolution_ns_ = resolution_ns;
+    expiries_.clear(clock_ns_ / resolution_ns);
+    return true;
+}
+
 // ============================================================================
 // Amend Order
 // ============================================================================
-bool OrderBook::amend_order(uint64_t order_id, double new_price, uint64_t new_quantity) {
+template<typename Policy>
+bool BasicOrderBook<Policy>::amend_order(uint64_t order_id, double new_price, uint64_t new_quantity) {
+    HFT_LATENCY_SCOPE(latency, amend);
+
     auto lookup_it = order_lookup_.find(order_id);
     if (lookup_it == order_lookup_.end()) {
         return false;  // Order not found
     }
+    if (new_quantity == 0) {
+        return cancel_order(order_id);
+    }
 
-    Order* order = lookup_it->second.order;
-    double old_price = order->price;
-    uint64_t old_quantity = order->quantity;
-
-    // If price changes, treat as cancel + add
-    if (new_price != old_price) {
-        // Save order details
-        Order new_order = *order;
-        new_order.price = new_price;
-        new_order.quantity = new_quantity;
+    PoolHandle handle = lookup_it->second;
+    OrderNode& node = order_pool_[handle];
+    Order& order = node.order;
+
+    if (new_price != order.price) {
+        bool crosses = mode_ == BookMode::Matching && !auction_ &&
+                       (order.is_buy ? new_price >= best_ask_.price : new_price <= best_bid_.price);
+        if (crosses) {
+            // It has to trade: cancel and add through the matcher
+            Order new_order = order;
+            new_order.price = new_price;
+            new_order.quantity = new_quantity;
+            cancel_order(order_id);
+            add_order(new_order);
+            return true;
+        }
 
-        // Cancel old order
-        cancel_order(order_id);
+        // Relink the same node at the back of the new level: no copy, no
+        // allocation, the lookup entry and any expiry timer stay as they are.
+        // An iceberg is re-sliced as on arrival.
+        leave_level(handle);
+        order.price = new_price;
+        if (order.is_iceberg() && new_quantity > order.display_quantity) {
+            order.quantity = order.display_quantity;
+            order.hidden_quantity = new_quantity - order.display_quantity;
+        } else {
+            order.quantity = new_quantity;
+            order.hidden_quantity = 0;
+            order.display_quantity = 0;
+        }
+        join_level(handle);
+        total_orders_cancelled_++;
+        total_orders_added_++;
+        return true;
+    }
 
-        // Add new order
-        add_order(new_order);
+    // Same price: update in place through the level pointer. An iceberg
+    // keeps its slice: growth goes to the reserve, and a cut comes out of
+    // the reserve first.
+    uint64_t old_quantity = order.quantity;
+    uint64_t old_hidden = order.hidden_quantity;
+    if (new_quantity == old_quantity + old_hidden) {
         return true;
     }
+    PriceLevelData& level = *node.level;
+    if (new_quantity < old_quantity + old_hidden) {
+        uint64_t cut = old_quantity + old_hidden - new_quantity;
+        uint64_t from_hidden = std::min(cut, old_hidden);
+        order.hidden_quantity -= from_hidden;
+        order.quantity -= cut - from_hidden;
+        if (order.hidden_quantity == 0) {
+            order.display_quantity = 0;  // Reserve gone: a plain order now
+        }
+    } else {
+        if (order.is_iceberg()) {
+            order.hidden_quantity = new_quantity - old_quantity;
+        } else {
+            order.quantity = new_quantity;
+        }
+        // An increase loses priority: O(1) relink to the back of the level
+        if (level.tail != handle) {
+            unlink(level, handle);
+            push_back(level, handle);
+        }
+    }
 
-    // Only quantity changes - update in place
-    if (new_quantity != old_quantity) {
-        const OrderLocation& loc = lookup_it->second;
+    level.total_quantity = level.total_quantity - old_quantity + order.quantity;
+    level.hidden_quantity = level.hidden_quantity - old_hidden + order.hidden_quantity;
+    touch_level(level, order.is_buy);
+    if (order.price == (order.is_buy ? best_bid_.price : best_ask_.price)) {
+        set_top(order.is_buy ? best_bid_ : best_ask_, level);
+    }
 
-        // Update quantity in the order
-        order->quantity = new_quantity;
+    // A same-price amend cannot cross: every add sweeps before it rests,
+    // so a matching book is never crossed outside an auction
+    return true;
+}
 
-        // Update total quantity at price level
-        if (loc.is_bid) {
-            auto it = bids_.find(loc.price);
-            if (it != bids_.end()) {
-                it->second.total_quantity = it->second.total_quantity - old_quantity + new_quantity;
-            }
-        } else {
-            auto it = asks_.find(loc.price);
-            if (it != asks_.end()) {
-                it->second.total_quantity = it->second.total_quantity - old_quantity + new_quantity;
-            }
-        }
+// ============================================================================
+// Execute / Reduce (venue-reported, no matching)
+// ============================================================================
+template<typename Policy>
+bool BasicOrderBook<Policy>::execute_order(uint64_t order_id, uint64_t quantity) {
+    if (mode_ != BookMode::Passive) {
+        return false;  // A matching book makes its own trades
+    }
+    auto lookup_it = order_lookup_.find(order_id);
+    if (lookup_it == order_lookup_.end()) {
+        return false;  // Order not found
+    }
+
+    PoolHandle handle = lookup_it->second;
+    const Order& order = order_pool_[handle].order;
+    uint64_t fill_qty = std::min(quantity, order.quantity);
+    if (fill_qty == 0) {
+        return true;  // Nothing traded
+    }
+
+    // The contra side is not ours to know; report it as order id 0
+    fills_.clear();
+    fills_.push_back(Trade{order.is_buy ? order_id : 0, order.is_buy ? 0 : order_id,
+                           order.price, fill_qty});
+    report_trades();
 
-        // Attempt to match orders (in case quantity increased)
-        match_orders();
+    if (execute_resting(handle, fill_qty)) {
+        order_lookup_.erase(lookup_it);
+    }
+    return true;
+}
+
+template<typename Policy>
+bool BasicOrderBook<Policy>::reduce_order(uint64_t order_id, uint64_t quantity) {
+    auto lookup_it = order_lookup_.find(order_id);
+    if (lookup_it == order_lookup_.end()) {
+        return false;  // Order not found
     }
 
+    if (reduce_resting(lookup_it->second, quantity)) {
+        order_lookup_.erase(lookup_it);
+        total_orders_cancelled_++;
+    }
     return true;
 }
 
+// Reduce a resting order in place (reserve first); returns true if it was
+// removed
+template<typename Policy>
+bool BasicOrderBook<Policy>::reduce_resting(PoolHandle handle, uint64_t quantity) {
+    Order& order = order_pool_[handle].order;
+    if (quantity >= order.quantity + order.hidden_quantity) {
+        remove_order_from_book(handle);
+        return true;
+    }
+
+    uint64_t from_hidden = std::min(quantity, order.hidden_quantity);
+    uint64_t from_displayed = quantity - from_hidden;
+    order.hidden_quantity -= from_hidden;
+    order.quantity -= from_displayed;
+    if (order.hidden_quantity == 0) {
+        order.display_quantity = 0;  // Reserve gone: a plain order now
+    }
+    PriceLevelData& level = *order_pool_[handle].level;
+    level.total_quantity -= from_displayed;
+    level.hidden_quantity -= from_hidden;
+    touch_level(level, order.is_buy);
+    if (order.price == (order.is_buy ? best_bid_.price : best_ask_.price)) {
+        set_top(order.is_buy ? best_bid_ : best_ask_, level);
+    }
+    return false;
+}
+
+// Fill a resting order's displayed slice in place; an iceberg whose slice
+// is used up cuts the next one and requeues at the back. Returns true if the
+// order was removed
+template<typename Policy>
+bool BasicOrderBook<Policy>::execute_resting(PoolHandle handle, uint64_t quantity) {
+    Order& order = order_pool_[handle].order;
+    if (quantity >= order.quantity && order.hidden_quantity == 0) {
+        remove_order_from_book(handle);
+        return true;
+    }
+
+    PriceLevelData& level = *order_pool_[handle].level;
+    order.quantity -= quantity;
+    level.total_quantity -= quantity;
+    if (order.quantity == 0) {
+        cut_slice(level, order);  // Next slice, back of the queue
+        unlink(level, handle);
+        push_back(level, handle);
+    }
+    touch_level(level, order.is_buy);
+    if (order.price == (order.is_buy ? best_bid_.price : best_ask_.price)) {
+        set_top(order.is_buy ? best_bid_ : best_ask_, level);
+    }
+    return false;
+}
+
 // ============================================================================
 // Get Snapshot
 // ============================================================================
-void OrderBook::get_snapshot(size_t depth, std::vector<PriceLevel>& bids, 
-                            std::vector<PriceLevel>& asks) const {
+template<typename Policy>
+void BasicOrderBook<Policy>::get_snapshot(size_t depth, std::vector<PriceLevel>& bids, 
+                                         std::vector<PriceLevel>& asks) const {
+    HFT_LATENCY_SCOPE(latency, snapshot);
+
     bids.clear();
     asks.clear();
 
@@ -161,7 +743,8 @@ void OrderBook::get_snapshot(size_t depth, std::vector<PriceLevel>& bids,
     size_t count = 0;
     for (const auto& [price, level_data] : bids_) {
         if (count >= depth) break;
-        bids.emplace_back(price, level_data.total_quantity);
+        bids.emplace_back(price, level_data.total_quantity, level_data.order_count,
+                          level_data.hidden_quantity);
         count++;
     }
 
@@ -169,15 +752,83 @@ void OrderBook::get_snapshot(size_t depth, std::vector<PriceLevel>& bids,
     count = 0;
     for (const auto& [price, level_data] : asks_) {
         if (count >= depth) break;
-        asks.emplace_back(price, level_data.total_quantity);
+        asks.emplace_back(price, level_data.total_quantity, level_data.order_count,
+                          level_data.hidden_quantity);
         count++;
     }
 }
 
+// ============================================================================
+// Level Change Tracking
+// ============================================================================
+template<typename Policy>
+void BasicOrderBook<Policy>::set_level_tracking(bool enabled) {
+    // Existing levels are considered known to the consumer (it is expected
+    // to take a full snapshot when it starts), and pending changes are dropped
+    for (auto& [price, level_data] : bids_) {
+        level_data.dirty = false;
+        level_data.reported = true;
+    }
+    for (auto& [price, level_data] : asks_) {
+        level_data.dirty = false;
+        level_data.reported = true;
+    }
+    dirty_levels_.clear();
+    track_level_changes_ = enabled;
+}
+
+template<typename Policy>
+size_t BasicOrderBook<Policy>::drain_level_changes(std::vector<LevelUpdate>& updates) {
+    updates.clear();
+
+    // A level deleted and re-created between drains is queued twice;
+    // merge the entries so the consumer sees one update per price
+    std::sort(dirty_levels_.begin(), dirty_levels_.end(),
+              [](const DirtyLevel& a, const DirtyLevel& b) {
+                  return a.is_bid != b.is_bid ? a.is_bid : a.price < b.price;
+              });
+    size_t merged = 0;
+    for (size_t i = 0; i < dirty_levels_.size(); ++i) {
+        if (merged > 0 && dirty_levels_[merged - 1].is_bid == dirty_levels_[i].is_bid &&
+            dirty_levels_[merged - 1].price == dirty_levels_[i].price) {
+            dirty_levels_[merged - 1].reported |= dirty_levels_[i].reported;
+        } else {
+            dirty_levels_[merged++] = dirty_levels_[i];
+        }
+    }
+    dirty_levels_.resize(merged);
+
+    // Report the current state of each level; absent levels were deleted
+    for (const DirtyLevel& dirty : dirty_levels_) {
+        PriceLevelData* level = nullptr;
+        if (dirty.is_bid) {
+            auto it = bids_.find(dirty.price);
+            if (it != bids_.end()) level = &it->second;
+        } else {
+            auto it = asks_.find(dirty.price);
+            if (it != asks_.end()) level = &it->second;
+        }
+
+        if (level) {
+            updates.push_back({dirty.is_bid, !(dirty.reported || level->reported),
+                               dirty.price, level->total_quantity, level->order_count});
+            level->dirty = false;
+            level->reported = true;
+        } else if (dirty.reported) {
+            // Deleted; a level created and deleted between drains is skipped
+            updates.push_back({dirty.is_bid, false, dirty.price, 0, 0});
+        }
+    }
+
+    dirty_levels_.clear();
+    return updates.size();
+}
+
 // ============================================================================
 // Print Book
 // ============================================================================
-void OrderBook::print_book(size_t depth) const {
+template<typename Policy>
+void BasicOrderBook<Policy>::print_book(size_t depth) const {
     std::vector<PriceLevel> bids, asks;
     get_snapshot(depth, bids, asks);
 
@@ -231,184 +882,644 @@ void OrderBook::print_book(size_t depth) const {
     std::cout << "  Total Orders Matched: " << total_orders_matched_ << "\n";
     std::cout << "  Bid Levels: " << bids_.size() << "\n";
     std::cout << "  Ask Levels: " << asks_.size() << "\n";
-    std::cout << "  Memory Pool Blocks: " << order_pool_.block_count() << "\n";
+    MemoryPoolStats pool = order_pool_.stats();
+    std::cout << "  Memory Pool Blocks: " << pool.block_count
+              << " (released: " << pool.blocks_released << ")\n";
+    std::cout << "  Memory Pool Orders: live " << pool.live
+              << " | peak " << pool.peak_live
+              << " | free " << pool.free << "\n";
     std::cout << "========================================\n\n";
 }
 
+template<typename Policy>
+void BasicOrderBook<Policy>::print_latency_stats() const {
+#ifdef HFT_LATENCY_STATS
+    std::cout << std::flush;
+    std::printf("Operation latency (rdtsc, %.3f ns/tick):\n", tsc::ns_per_tick());
+    latency_.print();
+    std::fflush(stdout);
+#else
+    std::cout << "Operation latency: not recorded (build with -DHFT_LATENCY_STATS=ON)\n";
+#endif
+}
+
 // ============================================================================
-// Match Orders
+// Sweep (incoming order against the opposite side)
 // ============================================================================
-void OrderBook::match_orders() {
-    while (!bids_.empty() && !asks_.empty()) {
-        auto best_bid_it = bids_.begin();
-        auto best_ask_it = asks_.begin();
+// Fills `order` against `levels` best first, FIFO within a level, while the
+// level price is within `limit`. Returns the unfilled quantity. The
+// incoming order is never in the book.
+//
+// The walk only consumes each level's queue from the head and appends to
+// fills_ / consumed_; lookup entries, pool slots and emptied levels are
+// released afterwards in one pass (the emptied levels are a prefix of the
+// side, so a single range erase), and trades are reported last, against
+// the settled book.
+//
+// Self-trade prevention costs one compare per resting order: the incoming
+// order's participant (or kStpDisabled) against the resting one's. An STP
+// cancel of the incoming remainder returns 0, having counted it cancelled.
+template<typename Policy>
+template<typename Levels>
+uint64_t BasicOrderBook<Policy>::sweep(Levels& levels, const Order& order, double limit) {
+    const bool resting_is_bid = !order.is_buy;
+    const uint32_t self = order.stp_id();
+    uint64_t remaining = order.quantity;
+    fills_.clear();
+    consumed_.clear();
+
+    auto level_it = levels.begin();
+    while (remaining > 0 && level_it != levels.end()) {
+        PriceLevelData& level = level_it->second;
+        if (order.is_buy ? limit < level.price : limit > level.price) {
+            break;
+        }
 
-        double best_bid_price = best_bid_it->first;
-        double best_ask_price = best_ask_it->first;
+        // Trades print at the sell price; a market sell has none, so it
+        // takes the bid it hits
+        double price = (order.is_buy || order.type == OrderType::Market) ? level.price : order.price;
 
-        // Check if orders can match
-        if (best_bid_price < best_ask_price) {
-            break;  // No match possible
+        if constexpr (Policy::kProRata) {
+            remaining = allocate(level, order, price, remaining);
+            touch_level(level, resting_is_bid);
+            if (!level.empty()) {
+                break;
+            }
+            ++level_it;
+            continue;
         }
 
-        // Get the first orders in each list (FIFO)
-        if (best_bid_it->second.orders.empty() || best_ask_it->second.orders.empty()) {
-            break;
+        PoolHandle handle = level.head;
+        while (remaining > 0 && handle != kInvalidHandle) {
+            Order& resting = order_pool_[handle].order;
+            if (resting.participant_id == self) {
+                SelfTrade outcome = prevent_self_trade(level, handle, order.stp, remaining);
+                remaining = outcome.remaining;
+                if (!outcome.resting_removed) {
+                    break;  // Resting order survives at the head
+                }
+                consumed_.push_back(handle);  // Dequeued like a filled order
+                level.order_count--;
+                handle = order_pool_[handle].next;
+                level.head = handle;
+                continue;
+            }
+            uint64_t trade_qty = std::min(remaining, resting.quantity);
+            fills_.push_back(order.is_buy ? Trade{order.order_id, resting.order_id, price, trade_qty}
+                                          : Trade{resting.order_id, order.order_id, price, trade_qty});
+            remaining -= trade_qty;
+            resting.quantity -= trade_qty;
+            level.total_quantity -= trade_qty;
+            if (resting.quantity > 0) {
+                break;  // Partially filled: keeps its place at the head
+            }
+            if (resting.hidden_quantity > 0) {
+                handle = replenish(level, handle);  // Next slice, back of the queue
+                continue;
+            }
+            consumed_.push_back(handle);
+            level.order_count--;
+            handle = order_pool_[handle].next;
+            level.head = handle;
         }
 
-        Order* buy_order = best_bid_it->second.orders.front();
-        Order* sell_order = best_ask_it->second.orders.front();
-
-        // Calculate trade quantity
-        uint64_t trade_qty = std::min(buy_order->quantity, sell_order->quantity);
+        touch_level(level, resting_is_bid);
+        if (handle != kInvalidHandle) {
+            order_pool_[handle].prev = kInvalidHandle;
+            break;  // Level survives; the sweep ends here
+        }
+        level.tail = kInvalidHandle;
+        ++level_it;
+    }
 
-        // Execute the trade
-        execute_trade(buy_order, sell_order, trade_qty);
+    for (PoolHandle handle : consumed_) {
+        order_lookup_.erase(order_pool_[handle].order.order_id);
+        if (order_pool_[handle].timer != kInvalidHandle) {
+            expiries_.cancel(order_pool_[handle].timer);
+        }
+        order_pool_.deallocate(handle);
+    }
+    levels.erase(levels.begin(), level_it);
 
-        // Update quantities
-        buy_order->quantity -= trade_qty;
-        sell_order->quantity -= trade_qty;
+    if (resting_is_bid) {
+        refresh_best_bid();
+    } else {
+        refresh_best_ask();
+    }
+    report_trades();
+    return remaining;
+}
 
-        best_bid_it->second.total_quantity -= trade_qty;
-        best_ask_it->second.total_quantity -= trade_qty;
+// A resting order in `level` belongs to the incoming order's participant.
+// Applies `mode` without trading: a cancelled resting order is taken off
+// the level's quantities and left for the caller to dequeue, and a
+// cancelled incoming remainder comes back as 0. Returned by value so the
+// sweep's loop state stays in registers.
+template<typename Policy>
+typename BasicOrderBook<Policy>::SelfTrade
+BasicOrderBook<Policy>::prevent_self_trade(PriceLevelData& level, PoolHandle handle, StpMode mode,
+                                           uint64_t remaining) {
+    Order& resting = order_pool_[handle].order;
+    uint64_t resting_total = resting.quantity + resting.hidden_quantity;
+
+    if (mode == StpMode::CancelNewest) {
+        total_orders_cancelled_++;
+        return {0, false};
+    }
+    if (mode == StpMode::Decrement && remaining < resting_total) {
+        // Incoming order decremented away; the resting one shrinks in
+        // place, reserve first, keeping its priority
+        uint64_t from_hidden = std::min(remaining, resting.hidden_quantity);
+        resting.hidden_quantity -= from_hidden;
+        resting.quantity -= remaining - from_hidden;
+        if (resting.hidden_quantity == 0) {
+            resting.display_quantity = 0;
+        }
+        level.hidden_quantity -= from_hidden;
+        level.total_quantity -= remaining - from_hidden;
+        total_orders_cancelled_++;
+        return {0, false};
+    }
 
-        // Remove fully filled orders
-        if (buy_order->quantity == 0) {
-            order_lookup_.erase(buy_order->order_id);
-            best_bid_it->second.orders.pop_front();
-            order_pool_.deallocate(buy_order);
+    // The resting order goes; under Decrement the incoming one shrinks by
+    // as much, under CancelBoth its remainder goes too
+    if (mode == StpMode::Decrement) {
+        remaining -= resting_total;
+        if (remaining == 0) {
+            total_orders_cancelled_++;
+        }
+    } else if (mode == StpMode::CancelBoth) {
+        total_orders_cancelled_++;
+        remaining = 0;
+    }
+    level.total_quantity -= resting.quantity;
+    level.hidden_quantity -= resting.hidden_quantity;
+    total_orders_cancelled_++;
+    return {remaining, true};
+}
 
-            // Remove price level if empty
-            if (best_bid_it->second.orders.empty()) {
-                bids_.erase(best_bid_it);
+// ============================================================================
+// Pro-Rata Allocation (Policy::kProRata)
+// ============================================================================
+// Shares `remaining` out at one level: self-matches are settled first, then
+// the top order and the LMM take their priority shares, then each round
+// either fills every displayed order in full (icebergs come back with a
+// new slice) or splits what is left pro-rata. Returns the quantity left,
+// which is 0 unless the level was emptied.
+template<typename Policy>
+uint64_t BasicOrderBook<Policy>::allocate(PriceLevelData& level, const Order& order, double price,
+                                          uint64_t remaining) {
+    const uint32_t self = order.stp_id();
+    if (self != kStpDisabled) {
+        for (PoolHandle handle = level.head; handle != kInvalidHandle && remaining > 0;) {
+            PoolHandle next = order_pool_[handle].next;
+            if (order_pool_[handle].order.participant_id == self) {
+                SelfTrade outcome = prevent_self_trade(level, handle, order.stp, remaining);
+                remaining = outcome.remaining;
+                if (outcome.resting_removed) {
+                    unlink(level, handle);
+                    consumed_.push_back(handle);
+                }
             }
+            handle = next;
         }
+    }
 
-        if (sell_order->quantity == 0) {
-            order_lookup_.erase(sell_order->order_id);
-            best_ask_it->second.orders.pop_front();
-            order_pool_.deallocate(sell_order);
+    if constexpr (Policy::kTopOrder) {
+        if (remaining > 0 && level.top != kInvalidHandle) {
+            uint64_t quantity = std::min(remaining, order_pool_[level.top].order.quantity);
+            take(level, level.top, order, price, quantity);
+            remaining -= quantity;
+        }
+    }
 
-            // Remove price level if empty
-            if (best_ask_it->second.orders.empty()) {
-                asks_.erase(best_ask_it);
+    if constexpr (Policy::kLmm) {
+        if (remaining > 0 && policy_.participant != kAnonymousParticipant) {
+            // Exact floor of remaining * percent / 100 without overflow
+            uint64_t share = remaining / 100 * policy_.percent + remaining % 100 * policy_.percent / 100;
+            for (PoolHandle handle = level.head; handle != kInvalidHandle && share > 0;) {
+                PoolHandle next = order_pool_[handle].next;
+                const Order& resting = order_pool_[handle].order;
+                if (resting.participant_id == policy_.participant) {
+                    uint64_t quantity = std::min(share, resting.quantity);
+                    take(level, handle, order, price, quantity);
+                    share -= quantity;
+                    remaining -= quantity;
+                }
+                handle = next;
             }
         }
     }
+
+    while (remaining > 0 && !level.empty()) {
+        if (remaining < level.total_quantity) {
+            return allocate_pro_rata(level, order, price, remaining);
+        }
+        allocation_orders_.clear();
+        for (PoolHandle handle = level.head; handle != kInvalidHandle; handle = order_pool_[handle].next) {
+            allocation_orders_.push_back(handle);
+        }
+        for (PoolHandle handle : allocation_orders_) {
+            uint64_t quantity = order_pool_[handle].order.quantity;
+            take(level, handle, order, price, quantity);
+            remaining -= quantity;
+        }
+    }
+    return remaining;
 }
 
-// ============================================================================
-// Execute Trade
-// ============================================================================
-void OrderBook::execute_trade(Order* buy_order, Order* sell_order, uint64_t trade_qty) {
-    total_orders_matched_++;
+// remaining < level.total_quantity. Each order gets its displayed size
+// times remaining / total, rounded down; the scaling runs branch-free over
+// contiguous doubles, so it vectorizes (truncating through int64 rather
+// than std::floor, which GCC only vectorizes without trapping math).
+// Rounding loses at most a lot or two per order, which are handed out one
+// per order, oldest first, so the split depends only on the sizes and the
+// queue. Double rounding can also over-allocate by a lot; that is taken
+// back newest first.
+template<typename Policy>
+uint64_t BasicOrderBook<Policy>::allocate_pro_rata(PriceLevelData& level, const Order& order,
+                                                   double price, uint64_t remaining) {
+    size_t count = level.order_count;
+    allocation_orders_.resize(count);
+    allocation_shares_.resize(count);
+    allocation_fills_.resize(count);
+    size_t i = 0;
+    for (PoolHandle handle = level.head; handle != kInvalidHandle; handle = order_pool_[handle].next, ++i) {
+        allocation_orders_[i] = handle;
+        allocation_fills_[i] = order_pool_[handle].order.quantity;
+        // Capped so the scaled share always fits the int64 conversion
+        allocation_shares_[i] = static_cast<double>(std::min(allocation_fills_[i], uint64_t{1} << 62));
+    }
+
+    const double ratio = static_cast<double>(remaining) / static_cast<double>(level.total_quantity);
+    double* shares = allocation_shares_.data();
+    for (i = 0; i < count; ++i) {
+        shares[i] = static_cast<double>(static_cast<int64_t>(shares[i] * ratio));
+    }
 
-    // Dummy execution
+    uint64_t allocated = 0;
+    for (i = 0; i < count; ++i) {
+        allocation_fills_[i] = std::min(allocation_fills_[i], static_cast<uint64_t>(shares[i]));
+        allocated += allocation_fills_[i];
+    }
+    // One lot per order per pass; sizes beyond double precision can be off
+    // by more, and are settled in larger steps
+    for (i = count; allocated > remaining; ) {
+        i = i == 0 ? count - 1 : i - 1;
+        uint64_t step = std::min({std::max<uint64_t>(1, (allocated - remaining) / count),
+                                  allocated - remaining, allocation_fills_[i]});
+        allocation_fills_[i] -= step;
+        allocated -= step;
+    }
+    for (i = 0; allocated < remaining; i = i + 1 == count ? 0 : i + 1) {
+        uint64_t room = order_pool_[allocation_orders_[i]].order.quantity - allocation_fills_[i];
+        uint64_t step = std::min({std::max<uint64_t>(1, (remaining - allocated) / count),
+                                  remaining - allocated, room});
+        allocation_fills_[i] += step;
+        allocated += step;
+    }
 
-    (void)buy_order;
-    (void)sell_order;
-    (void)trade_qty;
+    for (i = 0; i < count; ++i) {
+        if (allocation_fills_[i] > 0) {
+            take(level, allocation_orders_[i], order, price, allocation_fills_[i]);
+        }
+    }
+    return 0;
+}
 
-    
-    std::cout << "TRADE: Buy Order #" << buy_order->order_id 
-              << " x Sell Order #" << sell_order->order_id
-              << " | Qty: " << trade_qty 
-              << " | Price: " << sell_order->price << "\n";
+// Fill `quantity` of a resting order anywhere in `level`'s queue. A filled
+// order leaves the queue for consumed_; a filled iceberg slice is cut
+// again and the order moves to the back.
+template<typename Policy>
+void BasicOrderBook<Policy>::take(PriceLevelData& level, PoolHandle handle, const Order& order,
+                                  double price, uint64_t quantity) {
+    Order& resting = order_pool_[handle].order;
+    fills_.push_back(order.is_buy ? Trade{order.order_id, resting.order_id, price, quantity}
+                                  : Trade{resting.order_id, order.order_id, price, quantity});
+    resting.quantity -= quantity;
+    level.total_quantity -= quantity;
+    if (resting.quantity > 0) {
+        return;
+    }
+    unlink(level, handle);
+    if (resting.hidden_quantity > 0) {
+        cut_slice(level, resting);
+        push_back(level, handle);
+    } else {
+        consumed_.push_back(handle);
+    }
+}
+
+// FOK depth check: reads only the aggregated level quantities
+template<typename Policy>
+template<typename Levels>
+bool BasicOrderBook<Policy>::can_fill(const Levels& levels, const Order& order, double limit) const {
+    uint64_t available = 0;
+    for (const auto& [price, level_data] : levels) {
+        if (order.is_buy ? limit < price : limit > price) {
+            break;
+        }
+        available += level_data.total_quantity + level_data.hidden_quantity;
+        if (available >= order.quantity) {
+            return true;
+        }
+    }
+    return false;
 }
 
 // ============================================================================
-// Remove Order from Book (Helper)
+// Report Trades
 // ============================================================================
-void OrderBook::remove_order_from_book(const OrderLocation& loc) {
-    if (loc.is_bid) {
-        auto it = bids_.find(loc.price);
-        if (it != bids_.end()) {
-            // Update total quantity
-            it->second.total_quantity -= loc.order->quantity;
+template<typename Policy>
+void BasicOrderBook<Policy>::report_trades() {
+    total_orders_matched_ += fills_.size();
+    if (!fills_.empty()) {
+        // A sweep prints monotonically, so its extremes are the ends
+        double first = fills_.front().price;
+        double last = fills_.back().price;
+        trade_low_ = std::min(trade_low_, std::min(first, last));
+        trade_high_ = std::max(trade_high_, std::max(first, last));
+    }
+
+    if (trade_handler_) {
+        for (const Trade& trade : fills_) {
+            trade_handler_(trade, trade_context_);
+        }
+        return;
+    }
 
-            // Remove order from list
-            it->second.orders.erase(loc.list_iter);
+    for (const Trade& trade : fills_) {
+        std::cout << "TRADE: Buy Order #" << trade.buy_order_id 
+                  << " x Sell Order #" << trade.sell_order_id
+                  << " | Qty: " << trade.quantity 
+                  << " | Price: " << trade.price << "\n";
+    }
+}
 
-            // Deallocate order
-            order_pool_.deallocate(loc.order);
+// ============================================================================
+// Remove Order from Book (Helper)
+// ============================================================================
+template<typename Policy>
+void BasicOrderBook<Policy>::remove_order_from_book(PoolHandle handle) {
+    if (order_pool_[handle].timer != kInvalidHandle) {
+        expiries_.cancel(order_pool_[handle].timer);
+    }
+    leave_level(handle);
+    order_pool_.deallocate(handle);
+}
 
-            // Remove price level if empty
-            if (it->second.orders.empty()) {
-                bids_.erase(it);
+// Queue a resting order at the back of the level for its price, creating
+// the level if needed
+template<typename Policy>
+void BasicOrderBook<Policy>::join_level(PoolHandle handle) {
+    const Order& order = order_pool_[handle].order;
+    if (order.is_buy) {
+        auto it = bids_.find(order.price);
+        if (it == bids_.end()) {
+            it = bids_.emplace(std::piecewise_construct,
+                               std::forward_as_tuple(order.price),
+                               std::forward_as_tuple(order.price)).first;
+            if constexpr (Policy::kTopOrder) {
+                if (order.price > best_bid_.price) {
+                    it->second.top = handle;  // Set a new best bid
+                }
             }
         }
+        push_back(it->second, handle);
+        it->second.total_quantity += order.quantity;
+        it->second.hidden_quantity += order.hidden_quantity;
+        touch_level(it->second, true);
+
+        // Keep the cached top of book in step without touching the tree
+        if (order.price >= best_bid_.price) {
+            set_top(best_bid_, it->second);
+        }
     } else {
-        auto it = asks_.find(loc.price);
-        if (it != asks_.end()) {
-            // Update total quantity
-            it->second.total_quantity -= loc.order->quantity;
+        auto it = asks_.find(order.price);
+        if (it == asks_.end()) {
+            it = asks_.emplace(std::piecewise_construct,
+                               std::forward_as_tuple(order.price),
+                               std::forward_as_tuple(order.price)).first;
+            if constexpr (Policy::kTopOrder) {
+                if (order.price < best_ask_.price) {
+                    it->second.top = handle;  // Set a new best ask
+                }
+            }
+        }
+        push_back(it->second, handle);
+        it->second.total_quantity += order.quantity;
+        it->second.hidden_quantity += order.hidden_quantity;
+        touch_level(it->second, false);
 
-            // Remove order from list
-            it->second.orders.erase(loc.list_iter);
+        if (order.price <= best_ask_.price) {
+            set_top(best_ask_, it->second);
+        }
+    }
+}
 
-            // Deallocate order
-            order_pool_.deallocate(loc.order);
+// Take a resting order out of its level, erasing the level once empty.
+// The node stays allocated.
+template<typename Policy>
+void BasicOrderBook<Policy>::leave_level(PoolHandle handle) {
+    const Order& order = order_pool_[handle].order;
+    PriceLevelData& level = *order_pool_[handle].level;
+    double price = order.price;
+    level.total_quantity -= order.quantity;
+    level.hidden_quantity -= order.hidden_quantity;
+    touch_level(level, order.is_buy);
+    unlink(level, handle);
 
-            // Remove price level if empty
-            if (it->second.orders.empty()) {
-                asks_.erase(it);
-            }
+    if (order.is_buy) {
+        if (level.empty()) {
+            bids_.erase(price);
+        }
+        if (price == best_bid_.price) {
+            refresh_best_bid();
+        }
+    } else {
+        if (level.empty()) {
+            asks_.erase(price);
+        }
+        if (price == best_ask_.price) {
+            refresh_best_ask();
         }
     }
 }
 
 // ============================================================================
-// Get Best Bid
+// Level Queue Helpers
 // ============================================================================
-bool OrderBook::get_best_bid(double& price, uint64_t& quantity) const {
+template<typename Policy>
+void BasicOrderBook<Policy>::push_back(PriceLevelData& level, PoolHandle handle) {
+    OrderNode& node = order_pool_[handle];
+    node.prev = level.tail;
+    node.next = kInvalidHandle;
+    node.level = &level;
+    if (level.tail != kInvalidHandle) {
+        order_pool_[level.tail].next = handle;
+    } else {
+        level.head = handle;
+    }
+    level.tail = handle;
+    level.order_count++;
+}
+
+template<typename Policy>
+void BasicOrderBook<Policy>::unlink(PriceLevelData& level, PoolHandle handle) {
+    OrderNode& node = order_pool_[handle];
+    if (node.prev != kInvalidHandle) {
+        order_pool_[node.prev].next = node.next;
+    } else {
+        level.head = node.next;
+    }
+    if (node.next != kInvalidHandle) {
+        order_pool_[node.next].prev = node.prev;
+    } else {
+        level.tail = node.prev;
+    }
+    level.order_count--;
+    if constexpr (Policy::kTopOrder) {
+        if (level.top == handle) {
+            level.top = kInvalidHandle;  // Requeued or gone: top status is lost
+        }
+    }
+}
+
+// Cut an iceberg's next slice from its reserve and requeue it at the back
+// of `level` by relinking the node: same pool slot, same lookup entry. The
+// node must be the level's current head (the sweep consumes from the head).
+// Returns the new head.
+template<typename Policy>
+PoolHandle BasicOrderBook<Policy>::replenish(PriceLevelData& level, PoolHandle handle) {
+    OrderNode& node = order_pool_[handle];
+    cut_slice(level, node.order);
+
+    if (node.next == kInvalidHandle) {
+        return handle;  // Alone in the level: already at the back
+    }
+    PoolHandle next = node.next;
+    order_pool_[next].prev = kInvalidHandle;
+    level.head = next;
+    node.prev = level.tail;
+    node.next = kInvalidHandle;
+    order_pool_[level.tail].next = handle;
+    level.tail = handle;
+    return next;
+}
+
+// Cut an iceberg's next displayed slice from its reserve
+template<typename Policy>
+void BasicOrderBook<Policy>::cut_slice(PriceLevelData& level, Order& order) {
+    uint64_t slice = std::min(order.display_quantity, order.hidden_quantity);
+    order.hidden_quantity -= slice;
+    order.quantity = slice;
+    if (order.hidden_quantity == 0) {
+        order.display_quantity = 0;  // Last slice: a plain order now
+    }
+    level.hidden_quantity -= slice;
+    level.total_quantity += slice;
+}
+
+template<typename Policy>
+void BasicOrderBook<Policy>::refresh_best_bid() {
     if (bids_.empty()) {
+        best_bid_ = {-std::numeric_limits<double>::infinity(), 0, 0};
+    } else {
+        set_top(best_bid_, bids_.begin()->second);
+    }
+}
+
+template<typename Policy>
+void BasicOrderBook<Policy>::refresh_best_ask() {
+    if (asks_.empty()) {
+        best_ask_ = {std::numeric_limits<double>::infinity(), 0, 0};
+    } else {
+        set_top(best_ask_, asks_.begin()->second);
+    }
+}
+
+template<typename Policy>
+void BasicOrderBook<Policy>::release_level_orders(PriceLevelData& level) {
+    PoolHandle handle = level.head;
+    while (handle != kInvalidHandle) {
+        PoolHandle next = order_pool_[handle].next;
+        order_pool_.deallocate(handle);
+        handle = next;
+    }
+    level.head = level.tail = kInvalidHandle;
+    level.order_count = 0;
+}
+
+// ============================================================================
+// Get Best Bid
+// ============================================================================
+template<typename Policy>
+bool BasicOrderBook<Policy>::get_best_bid(double& price, uint64_t& quantity) const {
+    if (best_bid_.order_count == 0) {
         return false;
     }
 
-    auto it = bids_.begin();
-    price = it->first;
-    quantity = it->second.total_quantity;
+    price = best_bid_.price;
+    quantity = best_bid_.quantity;
     return true;
 }
 
 // ============================================================================
 // Get Best Ask
 // ============================================================================
-bool OrderBook::get_best_ask(double& price, uint64_t& quantity) const {
-    if (asks_.empty()) {
+template<typename Policy>
+bool BasicOrderBook<Policy>::get_best_ask(double& price, uint64_t& quantity) const {
+    if (best_ask_.order_count == 0) {
         return false;
     }
 
-    auto it = asks_.begin();
-    price = it->first;
-    quantity = it->second.total_quantity;
+    price = best_ask_.price;
+    quantity = best_ask_.quantity;
     return true;
 }
 
+// ============================================================================
+// Idle Maintenance
+// ============================================================================
+template<typename Policy>
+size_t BasicOrderBook<Policy>::on_idle() {
+    if (!pool_release_policy_.enabled) {
+        return 0;
+    }
+    return order_pool_.release_free_blocks(pool_release_policy_.min_retained_blocks);
+}
+
 // ============================================================================
 // Clear
 // ============================================================================
-void OrderBook::clear() {
+template<typename Policy>
+void BasicOrderBook<Policy>::clear() {
     // Deallocate all orders in bids
     for (auto& [price, level_data] : bids_) {
-        for (Order* order : level_data.orders) {
-            order_pool_.deallocate(order);
-        }
+        touch_level(level_data, true);
+        release_level_orders(level_data);
     }
 
     // Deallocate all orders in asks
     for (auto& [price, level_data] : asks_) {
-        for (Order* order : level_data.orders) {
-            order_pool_.deallocate(order);
-        }
+        touch_level(level_data, false);
+        release_level_orders(level_data);
     }
 
     bids_.clear();
     asks_.clear();
     order_lookup_.clear();
+    stops_.clear();
+    expiries_.clear(expiries_.now());
+    refresh_best_bid();
+    refresh_best_ask();
 
     total_orders_added_ = 0;
     total_orders_cancelled_ = 0;
     total_orders_matched_ = 0;
 }
 
+template class BasicOrderBook<FifoPolicy>;
+template class BasicOrderBook<ProRataPolicy>;
+template class BasicOrderBook<TopOrderProRataPolicy>;
+template class BasicOrderBook<LmmPolicy>;
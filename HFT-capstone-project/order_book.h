@@ -1,15 +1,76 @@
 #pragma once
 
+#include <cmath>
 #include <cstdint>
 #include <vector>
 #include <string>
 #include <map>
-#include <list>
 #include <unordered_map>
 #include <memory>
 #include <iostream>
 #include <iomanip>
 #include <chrono>
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <new>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include "latency_stats.h"
+
+// ============================================================================
+// Order Type & Time in Force
+// ============================================================================
+// Market orders carry no limit (price is ignored) and never rest. IOC trades
+// what it can on arrival and cancels the rest; FOK trades in full or not at
+// all. Only limit GTC and GTT orders ever rest in the book.
+//
+// Iceberg: a limit GTC order with display_quantity > 0 shows at most that
+// much. Submit the full size in `quantity`; once resting, `quantity` is the
+// displayed slice and `hidden_quantity` the reserve. When the slice fills,
+// the next one is cut from the reserve and the order goes to the back of
+// its level. Once the reserve is used up it is a plain order
+// (display_quantity 0), so a resting order is an iceberg exactly when
+// hidden_quantity > 0.
+//
+// Post-only: a limit order that must add liquidity. If it would cross the
+// best opposite price on arrival it is rejected (PostOnly) or repriced one
+// tick inside that price (PostOnlySlide); either way it never trades on
+// arrival. It rests with its type, so a price amend is checked again.
+enum class OrderType : uint8_t {
+    Limit = 0,
+    Market = 1,
+    PostOnly = 2,
+    PostOnlySlide = 3
+};
+
+enum class TimeInForce : uint8_t {
+    Gtc = 0,  // Good till cancelled
+    Ioc = 1,  // Immediate or cancel
+    Fok = 2,  // Fill or kill
+    Gtt = 3   // Good till time (Order::expire_ns); a GTD is a GTT at the day's end
+};
+
+// ============================================================================
+// Self-Trade Prevention
+// ============================================================================
+// The incoming order's mode decides what happens when it would match a
+// resting order of the same participant: cancel its own remainder (newest),
+// cancel the resting order (oldest) and keep sweeping, cancel both, or
+// decrement both by the smaller size without a trade. Fills before the
+// self-match stand; an FOK is checked on depth alone, so STP can still stop
+// it part-filled. Participant 0 is anonymous and never checked, and
+// kStpDisabled is reserved.
+enum class StpMode : uint8_t {
+    None = 0,
+    CancelNewest = 1,
+    CancelOldest = 2,
+    CancelBoth = 3,
+    Decrement = 4
+};
+
+constexpr uint32_t kAnonymousParticipant = 0;
+constexpr uint32_t kStpDisabled = std::numeric_limits<uint32_t>::max();
 
 // ============================================================================
 // Order Structure
@@ -17,109 +78,598 @@
 struct Order {
     uint64_t order_id;     
     bool is_buy;          
+    OrderType type = OrderType::Limit;
+    TimeInForce tif = TimeInForce::Gtc;
+    StpMode stp = StpMode::None;
+    uint32_t participant_id = kAnonymousParticipant;
     double price;
     uint64_t quantity;
     uint64_t timestamp_ns;
+    uint64_t display_quantity = 0;  // Iceberg slice size; 0 = fully displayed
+    uint64_t hidden_quantity = 0;   // Iceberg reserve (resting orders only)
+    uint64_t expire_ns = 0;         // TimeInForce::Gtt: engine time it expires at
 
     Order() = default;
-    Order(uint64_t id, bool buy, double p, uint64_t qty, uint64_t ts)
-        : order_id(id), is_buy(buy), price(p), quantity(qty), timestamp_ns(ts) {}
+    Order(uint64_t id, bool buy, double p, uint64_t qty, uint64_t ts,
+          OrderType t = OrderType::Limit, TimeInForce time_in_force = TimeInForce::Gtc)
+        : order_id(id), is_buy(buy), type(t), tif(time_in_force)
+        , price(p), quantity(qty), timestamp_ns(ts) {}
+
+    bool is_iceberg() const { return display_quantity > 0; }
+
+    // The id resting orders are compared against while this order sweeps
+    uint32_t stp_id() const {
+        return stp != StpMode::None && participant_id != kAnonymousParticipant ? participant_id
+                                                                               : kStpDisabled;
+    }
 };
+static_assert(sizeof(Order) == 64, "Order must stay one cache line");
 
 // ============================================================================
 // PriceLevel Structure
 // ============================================================================
 struct PriceLevel {
     double price;
-    uint64_t total_quantity;
+    uint64_t total_quantity;   // Displayed
+    uint32_t order_count;
+    uint64_t hidden_quantity;  // Iceberg reserve, not shown in market data
 
     PriceLevel() = default;
-    PriceLevel(double p, uint64_t qty) : price(p), total_quantity(qty) {}
+    PriceLevel(double p, uint64_t qty, uint32_t count = 0, uint64_t hidden = 0)
+        : price(p), total_quantity(qty), order_count(count), hidden_quantity(hidden) {}
+};
+
+// ============================================================================
+// Trade Structure (reported through the book's trade handler)
+// ============================================================================
+struct Trade {
+    uint64_t buy_order_id;
+    uint64_t sell_order_id;
+    double price;
+    uint64_t quantity;
+};
+
+// Called synchronously for every fill, once the incoming order has been
+// fully matched; replaces the default console print. Must not modify the
+// book it is reporting for.
+using TradeHandler = void (*)(const Trade& trade, void* context);
+
+// ============================================================================
+// LevelUpdate Structure (aggregated level change, order_count 0 = deleted)
+// ============================================================================
+struct LevelUpdate {
+    bool is_bid;
+    bool is_new;  // Level was created since the consumer last saw it
+    double price;
+    uint64_t total_quantity;
+    uint32_t order_count;
+};
+
+// ============================================================================
+// Book Mode
+// ============================================================================
+// Matching: the book is the venue and crosses incoming orders.
+// Passive:  the book mirrors a venue from a feed; orders are kept exactly as
+//           reported and nothing is ever matched locally.
+enum class BookMode : uint8_t {
+    Matching,
+    Passive
+};
+
+// ============================================================================
+// Call Auction
+// ============================================================================
+// An uncross at one price. buy_quantity is the demand there (bids at or
+// above it) and sell_quantity the supply (asks at or below it), iceberg
+// reserves included; volume is the smaller of the two. price is NaN, and
+// the quantities 0, when nothing crosses.
+struct AuctionResult {
+    double price;
+    uint64_t volume;
+    uint64_t buy_quantity;
+    uint64_t sell_quantity;
+};
+
+// ============================================================================
+// Top of Book (cached best bid / ask)
+// ============================================================================
+struct TopOfBook {
+    double price;          // -inf / +inf when the side is empty
+    uint64_t quantity;
+    uint32_t order_count;
+};
+
+// ============================================================================
+// Memory Pool Statistics
+// ============================================================================
+struct MemoryPoolStats {
+    size_t block_count;      // Blocks currently held by the pool
+    size_t capacity;         // Total element slots across all blocks
+    size_t live;             // Elements currently allocated
+    size_t peak_live;        // High-water mark of live elements
+    size_t free;             // Slots available without growing
+    size_t blocks_released;  // Blocks returned to the OS so far
+};
+
+// Occupancy of a single block (computed off the hot path)
+struct MemoryPoolBlockOccupancy {
+    const void* base;
+    size_t live;
+    size_t capacity;
+};
+
+// Opt-in policy for returning fully free blocks during idle periods
+struct PoolReleasePolicy {
+    bool enabled = false;
+    size_t min_retained_blocks = 1;  // Never shrink below this many blocks
 };
 
 // ============================================================================
 // Memory Pool for Order Allocation (Cache-Friendly)
 // ============================================================================
+// Elements live in fixed-size slabs and are addressed by a 32-bit handle
+// (slab index * BlockSize + slot), which is half the size of a pointer and
+// stays valid for the lifetime of the element.
+using PoolHandle = uint32_t;
+constexpr PoolHandle kInvalidHandle = std::numeric_limits<PoolHandle>::max();
+
 template<typename T, size_t BlockSize = 4096>
 class MemoryPool {
 private:
+    static_assert((BlockSize & (BlockSize - 1)) == 0, "BlockSize must be a power of two");
+    static_assert(sizeof(T) >= sizeof(PoolHandle), "T must be able to hold a free-list link");
+
+    static constexpr uint32_t block_shift() {
+        uint32_t shift = 0;
+        while ((size_t{1} << shift) < BlockSize) shift++;
+        return shift;
+    }
+    static constexpr uint32_t kShift = block_shift();
+    static constexpr PoolHandle kMask = static_cast<PoolHandle>(BlockSize - 1);
+    static constexpr size_t kMaxBlocks = (size_t{1} << 32) / BlockSize;
+
     struct Block {
-        uint8_t data[BlockSize * sizeof(T)];
-        Block* next;
-        
-        Block() : next(nullptr) {}
+        alignas(T) uint8_t data[BlockSize * sizeof(T)];
     };
 
-    Block* blocks_;
-    T* free_list_;
+    std::vector<Block*> blocks_;   // Indexed by handle >> kShift; nullptr once released
+    PoolHandle free_list_;
+    PoolHandle fresh_;             // [fresh_, fresh_end_): never-used slots of the newest block
+    PoolHandle fresh_end_;
     size_t block_count_;
+    size_t live_count_;
+    size_t peak_live_;
+    size_t blocks_released_;
+
+    T* slot(PoolHandle h) const {
+        return reinterpret_cast<T*>(blocks_[h >> kShift]->data) + (h & kMask);
+    }
+
+    static PoolHandle& link(T* element) {
+        return *reinterpret_cast<PoolHandle*>(element);
+    }
 
     void allocate_block() {
-        Block* new_block = new Block();
-        new_block->next = blocks_;
-        blocks_ = new_block;
+        // Reuse the index of a released block before growing the table
+        size_t index = blocks_.size();
+        for (size_t i = 0; i < blocks_.size(); ++i) {
+            if (!blocks_[i]) {
+                index = i;
+                break;
+            }
+        }
+        if (index >= kMaxBlocks) {
+            throw std::bad_alloc();
+        }
+
+        // Blocks come straight from mmap so that release_free_blocks()
+        // really hands the pages back to the OS instead of the malloc arena
+        void* mem = mmap(nullptr, sizeof(Block), PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mem == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        if (index == blocks_.size()) {
+            blocks_.push_back(nullptr);
+        }
+        // Default-initialised, not value-initialised: Block() would zero the
+        // whole slab and fault in every page before anything is stored
+        blocks_[index] = new (mem) Block;
         block_count_++;
 
-        // Add all elements in the block to the free list
-        T* block_start = reinterpret_cast<T*>(new_block->data);
-        for (size_t i = 0; i < BlockSize; ++i) {
-            T* element = block_start + i;
-            *reinterpret_cast<T**>(element) = free_list_;
-            free_list_ = element;
+        // Hand out the new block's slots in ascending order straight from a
+        // bump range: a fresh block's pages are first touched by the element
+        // that lands there, not by a pass that threads a free list
+        fresh_ = static_cast<PoolHandle>(index << kShift);
+        fresh_end_ = static_cast<PoolHandle>(fresh_ + BlockSize);
+    }
+
+    static void free_block(Block* block) {
+        block->~Block();
+        munmap(block, sizeof(Block));
+    }
+
+    // Free slot count per block, indexed like blocks_
+    std::vector<size_t> free_counts() const {
+        std::vector<size_t> counts(blocks_.size(), 0);
+        for (PoolHandle h = free_list_; h != kInvalidHandle; h = link(slot(h))) {
+            counts[h >> kShift]++;
+        }
+        if (fresh_ != fresh_end_) {
+            counts[fresh_ >> kShift] += static_cast<size_t>(fresh_end_ - fresh_);
         }
+        return counts;
     }
 
 public:
-    MemoryPool() : blocks_(nullptr), free_list_(nullptr), block_count_(0) {
+    MemoryPool()
+        : free_list_(kInvalidHandle), fresh_(0), fresh_end_(0), block_count_(0)
+        , live_count_(0), peak_live_(0), blocks_released_(0) {
         allocate_block();
     }
 
     ~MemoryPool() {
-        while (blocks_) {
-            Block* next = blocks_->next;
-            delete blocks_;
-            blocks_ = next;
+        for (Block* block : blocks_) {
+            if (block) free_block(block);
         }
     }
 
-    T* allocate() {
-        if (!free_list_) {
-            allocate_block();
+    PoolHandle allocate() {
+        PoolHandle h;
+        T* element;
+        if (free_list_ != kInvalidHandle) {
+            h = free_list_;
+            element = slot(h);
+            free_list_ = link(element);
+        } else {
+            if (fresh_ == fresh_end_) {
+                allocate_block();
+            }
+            h = fresh_++;
+            element = slot(h);
         }
-        T* element = free_list_;
-        free_list_ = *reinterpret_cast<T**>(element);
-        return new (element) T(); 
+        if (++live_count_ > peak_live_) {
+            peak_live_ = live_count_;
+        }
+        new (element) T();
+        return h;
     }
 
-    void deallocate(T* element) {
-        if (!element) return;
+    void deallocate(PoolHandle h) {
+        if (h == kInvalidHandle) return;
+        T* element = slot(h);
         element->~T();  // Call destructor
-        *reinterpret_cast<T**>(element) = free_list_;
-        free_list_ = element;
+        link(element) = free_list_;
+        free_list_ = h;
+        live_count_--;
     }
 
+    T& operator[](PoolHandle h) { return *slot(h); }
+    const T& operator[](PoolHandle h) const { return *slot(h); }
+
     size_t block_count() const { return block_count_; }
+    size_t live_count() const { return live_count_; }
+    size_t peak_live() const { return peak_live_; }
+    size_t capacity() const { return block_count_ * BlockSize; }
+
+    MemoryPoolStats stats() const {
+        return MemoryPoolStats{block_count_, capacity(), live_count_, peak_live_,
+                               capacity() - live_count_, blocks_released_};
+    }
+
+    // Per-block occupancy census. Walks the free list, so O(free);
+    // meant for monitoring, never for the order path.
+    std::vector<MemoryPoolBlockOccupancy> block_occupancy() const {
+        std::vector<size_t> free = free_counts();
+        std::vector<MemoryPoolBlockOccupancy> census;
+        census.reserve(block_count_);
+        for (size_t i = 0; i < blocks_.size(); ++i) {
+            if (blocks_[i]) {
+                census.push_back({blocks_[i], BlockSize - free[i], BlockSize});
+            }
+        }
+        return census;
+    }
+
+    // Return fully free blocks to the OS, keeping at least min_retained blocks.
+    // Rebuilds the free list, so call it only while the book is idle.
+    size_t release_free_blocks(size_t min_retained) {
+        if (block_count_ <= min_retained || live_count_ == capacity()) {
+            return 0;
+        }
+
+        std::vector<size_t> free = free_counts();
+        std::vector<bool> release(blocks_.size(), false);
+        size_t releasable = block_count_ - min_retained;
+        size_t released = 0;
+        // Prefer releasing the highest blocks so handles stay dense
+        for (size_t i = blocks_.size(); i-- > 0 && released < releasable;) {
+            if (blocks_[i] && free[i] == BlockSize) {
+                release[i] = true;
+                released++;
+            }
+        }
+        if (released == 0) {
+            return 0;
+        }
+
+        // Drop released slots from the free list, keeping the order of the rest
+        PoolHandle kept_head = kInvalidHandle;
+        PoolHandle* tail = &kept_head;
+        for (PoolHandle h = free_list_; h != kInvalidHandle;) {
+            PoolHandle next = link(slot(h));
+            if (!release[h >> kShift]) {
+                *tail = h;
+                tail = &link(slot(h));
+            }
+            h = next;
+        }
+        *tail = kInvalidHandle;
+        free_list_ = kept_head;
+        if (fresh_ != fresh_end_ && release[fresh_ >> kShift]) {
+            fresh_ = fresh_end_ = 0;
+        }
+
+        for (size_t i = 0; i < blocks_.size(); ++i) {
+            if (release[i]) {
+                free_block(blocks_[i]);
+                blocks_[i] = nullptr;
+            }
+        }
+        while (!blocks_.empty() && !blocks_.back()) {
+            blocks_.pop_back();
+        }
+
+        block_count_ -= released;
+        blocks_released_ += released;
+        return released;
+    }
 
     // Prevent copying
     MemoryPool(const MemoryPool&) = delete;
     MemoryPool& operator=(const MemoryPool&) = delete;
 };
 
+// ============================================================================
+// Stop Trigger Book (stop_book.cpp)
+// ============================================================================
+// Pending stop and stop-limit orders. A buy stop triggers when a trade prints
+// at or above its trigger price, a sell stop at or below. Triggers are kept
+// in integer ticks, one FIFO bucket per trigger price and side, ordered
+// nearest first. The nearest trigger on each side is cached as a price
+// threshold (half a tick inside it, so rounding can only cause a spurious
+// check, never a missed one), and checking a trade range costs two
+// compares unless it actually triggers something.
+//
+// Triggered orders come out nearest trigger first, FIFO within a trigger
+// price, buys before sells, and carry the order as submitted: a market
+// order for a stop, a limit order for a stop-limit.
+class StopBook {
+private:
+    struct StopNode {
+        Order order;
+        int64_t trigger;  // Ticks
+        PoolHandle prev;
+        PoolHandle next;
+    };
+
+    struct Bucket {
+        PoolHandle head = kInvalidHandle;
+        PoolHandle tail = kInvalidHandle;
+    };
+
+    std::map<int64_t, Bucket> buy_stops_;                          // Lowest trigger first
+    std::map<int64_t, Bucket, std::greater<int64_t>> sell_stops_;  // Highest trigger first
+    int64_t buy_trigger_;   // Lowest buy trigger; INT64_MAX when none
+    int64_t sell_trigger_;  // Highest sell trigger; INT64_MIN when none
+    double buy_threshold_;  // Trades at or above may trigger a buy stop
+    double sell_threshold_; // Trades at or below may trigger a sell stop
+    std::unordered_map<uint64_t, PoolHandle> lookup_;
+    MemoryPool<StopNode> pool_;
+    double tick_size_;
+
+    template<typename Buckets>
+    void drain(Buckets& buckets, typename Buckets::iterator last, std::vector<Order>& out);
+    void refresh_triggers();
+
+public:
+    explicit StopBook(double tick_size = 0.01);
+
+    // Trigger prices are bucketed in ticks of this size; only while empty
+    bool set_tick_size(double tick_size);
+    double tick_size() const { return tick_size_; }
+    int64_t to_ticks(double price) const { return std::llround(price / tick_size_); }
+
+    // False if the id is already pending
+    bool add(const Order& order, double trigger_price);
+    bool cancel(uint64_t order_id);
+    bool contains(uint64_t order_id) const { return lookup_.count(order_id) != 0; }
+
+    // Whether trades printed within [low, high] may trigger anything
+    bool triggers(double low, double high) const {
+        return high >= buy_threshold_ || low <= sell_threshold_;
+    }
+
+    // Remove the stops triggered by [low, high] and append them to `out`
+    // in injection order; returns how many
+    size_t collect(double low, double high, std::vector<Order>& out);
+
+    size_t size() const { return lookup_.size(); }
+    bool empty() const { return lookup_.empty(); }
+    void clear();
+
+    // Visit pending stops (order, trigger price) in injection order
+    template<typename Visitor>
+    void for_each(Visitor&& visit) const {
+        for (const auto& [trigger, bucket] : buy_stops_) {
+            for (PoolHandle h = bucket.head; h != kInvalidHandle; h = pool_[h].next) {
+                visit(pool_[h].order, static_cast<double>(trigger) * tick_size_);
+            }
+        }
+        for (const auto& [trigger, bucket] : sell_stops_) {
+            for (PoolHandle h = bucket.head; h != kInvalidHandle; h = pool_[h].next) {
+                visit(pool_[h].order, static_cast<double>(trigger) * tick_size_);
+            }
+        }
+    }
+
+    StopBook(const StopBook&) = delete;
+    StopBook& operator=(const StopBook&) = delete;
+};
+
+// ============================================================================
+// Hierarchical Timing Wheel (timer_wheel.cpp)
+// ============================================================================
+// Timers keyed by an integer tick, each carrying a 64-bit payload. Level k
+// has 256 slots of 256^k ticks; a timer sits in the lowest level whose span
+// covers its distance from now, and cascades one level down each time the
+// wheel reaches its slot. Arm and cancel are O(1) list operations. Per-level
+// occupancy bitmaps let advance() jump straight to the next occupied slot,
+// so a long quiet gap costs a few bit scans, not a walk over every tick.
+// Timers beyond the top level's span wait in its furthest slot and are
+// re-placed when it cascades.
+class TimerWheel {
+public:
+    static constexpr int kLevels = 5;
+    static constexpr int kSlotBits = 8;
+    static constexpr size_t kSlots = size_t{1} << kSlotBits;
+
+private:
+    struct TimerNode {
+        uint64_t payload;
+        uint64_t expire;  // Tick
+        PoolHandle prev;
+        PoolHandle next;
+        uint32_t slot;    // level * kSlots + index
+    };
+
+    struct Slot {
+        PoolHandle head = kInvalidHandle;
+        PoolHandle tail = kInvalidHandle;
+    };
+
+    Slot slots_[kLevels * kSlots];
+    uint64_t occupied_[kLevels][kSlots / 64];
+    MemoryPool<TimerNode> pool_;
+    uint64_t now_;
+    size_t size_;
+
+    void link(PoolHandle handle);
+    void unlink(PoolHandle handle);
+    PoolHandle detach(uint32_t slot);
+    int next_occupied(int level, size_t from) const;
+    uint64_t next_event() const;
+
+public:
+    explicit TimerWheel(uint64_t now_tick = 0);
+
+    // Arm a timer for `expire_tick` (at least now() + 1)
+    PoolHandle arm(uint64_t expire_tick, uint64_t payload);
+    void cancel(PoolHandle timer);
+
+    // Move the wheel to `tick`, appending the payloads of every timer due by
+    // then to `expired`: in tick order, and in a deterministic order within
+    // a tick. Returns how many expired.
+    size_t advance(uint64_t tick, std::vector<uint64_t>& expired);
+
+    uint64_t now() const { return now_; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    // Drop every timer and restart the wheel at `now_tick`
+    void clear(uint64_t now_tick);
+
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+};
+
+// ============================================================================
+// Matching Policies
+// ============================================================================
+// How an incoming order is shared among the resting orders of a level it
+// cannot clear; a level it can clear is taken whole under every policy.
+// The policy is a template parameter of BasicOrderBook, so each book is
+// compiled for exactly one: FIFO is the plain price-time loop, with no
+// allocation code in it.
+//
+//   FifoPolicy             price-time priority (OrderBook)
+//   ProRataPolicy          in proportion to displayed size, rounded down;
+//                          lots lost to rounding go one each to the oldest
+//                          orders, so the split is deterministic
+//   TopOrderProRataPolicy  the top order (the one that set a new best price
+//                          by opening the level, while it keeps its place)
+//                          is filled first, then pro-rata
+//   LmmPolicy              the lead market maker's orders take `percent` of
+//                          the incoming quantity at the level first, oldest
+//                          first; the rest is pro-rata
+//
+// Under the pro-rata policies self-trade prevention is applied to the
+// level's orders of the same participant, oldest first, before anything
+// is allocated.
+struct FifoPolicy {
+    static constexpr bool kProRata = false;
+    static constexpr bool kTopOrder = false;
+    static constexpr bool kLmm = false;
+};
+
+struct ProRataPolicy {
+    static constexpr bool kProRata = true;
+    static constexpr bool kTopOrder = false;
+    static constexpr bool kLmm = false;
+};
+
+struct TopOrderProRataPolicy {
+    static constexpr bool kProRata = true;
+    static constexpr bool kTopOrder = true;
+    static constexpr bool kLmm = false;
+};
+
+struct LmmPolicy {
+    static constexpr bool kProRata = true;
+    static constexpr bool kTopOrder = false;
+    static constexpr bool kLmm = true;
+    uint32_t participant = kAnonymousParticipant;  // Anonymous: no LMM
+    uint32_t percent = 0;                           // Share of each level's allocation
+};
+
 // ============================================================================
 // Order Book Class
 // ============================================================================
-class OrderBook {
+template<typename Policy>
+class BasicOrderBook {
 private:
-    // Price level data structure: list of orders at each price
-    // Using std::list for O(1) insertion/deletion 
-    using OrderList = std::list<Order*>;
-    
+    // Orders live in the pool slab and are referred to by 32-bit handle.
+    // Each slot carries the FIFO links of its price level, so level queues,
+    // the id lookup and trade events never store a 64-bit pointer. The
+    // level pointer lets an order reach its level without a tree lookup;
+    // map nodes never move, and a level is only erased once empty.
+    struct PriceLevelData;
+    struct OrderNode {
+        Order order;
+        PoolHandle prev;
+        PoolHandle next;
+        PoolHandle timer;  // GTT expiry timer, kInvalidHandle if none
+        PriceLevelData* level;
+    };
+
+    // Price level data structure: intrusive FIFO of order handles
     struct PriceLevelData {
         double price;
-        OrderList orders;
-        uint64_t total_quantity;
+        PoolHandle head;
+        PoolHandle tail;
+        uint32_t order_count;
+        PoolHandle top;  // Top order (Policy::kTopOrder only), kInvalidHandle if none
+        bool dirty;     // Already queued in dirty_levels_
+        bool reported;  // Consumer of level changes has seen this level
+        uint64_t total_quantity;   // Displayed quantity
+        uint64_t hidden_quantity;  // Iceberg reserve behind it
+
+        PriceLevelData(double p)
+            : price(p), head(kInvalidHandle), tail(kInvalidHandle)
+            , order_count(0), top(kInvalidHandle), dirty(false), reported(false)
+            , total_quantity(0), hidden_quantity(0) {}
 
-        PriceLevelData(double p) : price(p), total_quantity(0) {}
+        bool empty() const { return head == kInvalidHandle; }
     };
 
     // Bids: sorted descending (highest price first)
@@ -127,42 +677,194 @@ private:
     std::map<double, PriceLevelData, std::greater<double>> bids_;  // Descending
     std::map<double, PriceLevelData, std::less<double>> asks_;     // Ascending
 
-    // Fast O(1) order lookup: order_id -> (Order*, iterator in price level)
-    struct OrderLocation {
-        Order* order;
-        OrderList::iterator list_iter;
+    // Cached best bid/ask, updated on every mutation that touches the top.
+    // Empty sides hold an infinite price so crossing checks need no branch
+    // on emptiness.
+    TopOfBook best_bid_;
+    TopOfBook best_ask_;
+
+    // Level change tracking. level_version_ bumps on every level mutation;
+    // when tracking is enabled each changed level is queued once (by price)
+    // until drain_level_changes() consumes the queue.
+    struct DirtyLevel {
         bool is_bid;
+        bool reported;  // Level had been reported when it was queued
         double price;
     };
-    std::unordered_map<uint64_t, OrderLocation> order_lookup_;
+    uint64_t level_version_;
+    bool track_level_changes_;
+    std::vector<DirtyLevel> dirty_levels_;
+
+    // Fast O(1) order lookup: order_id -> handle into the order pool
+    std::unordered_map<uint64_t, PoolHandle> order_lookup_;
 
     // Memory pool for efficient order allocation
-    MemoryPool<Order, 4096> order_pool_;
+    MemoryPool<OrderNode, 4096> order_pool_;
+    PoolReleasePolicy pool_release_policy_;
+
+    BookMode mode_;
+    Policy policy_;
+
+    // Trade reporting
+    TradeHandler trade_handler_;
+    void* trade_context_;
 
     // Statistics
     uint64_t total_orders_added_;
     uint64_t total_orders_cancelled_;
     uint64_t total_orders_matched_;
 
+#ifdef HFT_LATENCY_STATS
+    mutable OrderBookLatency latency_;  // Per-operation latency; get_snapshot() is const
+#endif
+
+    // Sweep scratch, reused across orders so matching never allocates once
+    // warmed up: fills in execution order, and fully filled resting orders
+    std::vector<Trade> fills_;
+    std::vector<PoolHandle> consumed_;
+
+    // Pro-rata allocation scratch, one entry per order of the level in
+    // queue order: handle, displayed size (then its scaled share), fill
+    std::vector<PoolHandle> allocation_orders_;
+    std::vector<double> allocation_shares_;
+    std::vector<uint64_t> allocation_fills_;
+
+    // Pending stops, and the price range traded since the last trigger
+    // check (low > high when nothing traded)
+    StopBook stops_;
+    std::vector<Order> triggered_;
+    double trade_low_;
+    double trade_high_;
+
+    // Arrival checks against the cached top of book: the widest a limit may
+    // be through the best opposite price (infinite when off), and the price
+    // grid post-only orders slide on, as 1 / tick size
+    double price_band_;
+    double ticks_per_unit_;
+
+    // Call auction: set from begin_auction() to uncross(), while orders
+    // only accumulate. The uncross fills of each side, in priority order,
+    // are paired into trades once both sides are settled; a large uncross
+    // marks its filled orders by pool handle to release them in bulk.
+    struct AuctionFill {
+        uint64_t order_id;
+        uint64_t quantity;
+    };
+    bool auction_;
+    std::vector<AuctionFill> auction_buys_;
+    std::vector<AuctionFill> auction_sells_;
+    std::vector<uint8_t> auction_marks_;
+
+    // GTT expiry: engine clock and timers in ticks of expiry_resolution_ns_;
+    // payloads are order pool handles
+    TimerWheel expiries_;
+    uint64_t clock_ns_;
+    uint64_t expiry_resolution_ns_;
+    std::vector<uint64_t> expired_;
+
     // Helper methods
-    void match_orders();
-    void execute_trade(Order* buy_order, Order* sell_order, uint64_t trade_qty);
-    void remove_order_from_book(const OrderLocation& loc);
+    uint64_t expiry_tick(uint64_t expire_ns) const {
+        return (expire_ns + expiry_resolution_ns_ - 1) / expiry_resolution_ns_;  // Never early
+    }
+    void place_order(const Order& order);
+    void trigger_stops();
+    template<typename Levels>
+    uint64_t sweep(Levels& levels, const Order& order, double limit);
+    template<typename Levels>
+    bool can_fill(const Levels& levels, const Order& order, double limit) const;
+    template<typename Levels>
+    void fill_auction_side(Levels& levels, bool is_bid, uint64_t volume,
+                           std::vector<AuctionFill>& fills);
+    void release_auction_fills();
+    struct SelfTrade {
+        uint64_t remaining;    // Incoming quantity left to match
+        bool resting_removed;  // Caller dequeues it
+    };
+    SelfTrade prevent_self_trade(PriceLevelData& level, PoolHandle handle, StpMode mode,
+                                 uint64_t remaining);
+    uint64_t allocate(PriceLevelData& level, const Order& order, double price, uint64_t remaining);
+    uint64_t allocate_pro_rata(PriceLevelData& level, const Order& order, double price,
+                               uint64_t remaining);
+    void take(PriceLevelData& level, PoolHandle handle, const Order& order, double price,
+              uint64_t quantity);
+    void report_trades();
+    void remove_order_from_book(PoolHandle handle);
+    void join_level(PoolHandle handle);
+    void leave_level(PoolHandle handle);
+    bool reduce_resting(PoolHandle handle, uint64_t quantity);
+    bool execute_resting(PoolHandle handle, uint64_t quantity);
+    void push_back(PriceLevelData& level, PoolHandle handle);
+    void unlink(PriceLevelData& level, PoolHandle handle);
+    PoolHandle replenish(PriceLevelData& level, PoolHandle handle);
+    void cut_slice(PriceLevelData& level, Order& order);
+    void release_level_orders(PriceLevelData& level);
+    void refresh_best_bid();
+    void refresh_best_ask();
+
+    void touch_level(PriceLevelData& level, bool is_bid) {
+        level_version_++;
+        if (track_level_changes_ && !level.dirty) {
+            level.dirty = true;
+            dirty_levels_.push_back({is_bid, level.reported, level.price});
+        }
+    }
+
+    static void set_top(TopOfBook& top, const PriceLevelData& level) {
+        top.price = level.price;
+        top.quantity = level.total_quantity;
+        top.order_count = level.order_count;
+    }
 
 public:
-    OrderBook();
-    ~OrderBook();
+    explicit BasicOrderBook(BookMode mode = BookMode::Matching);
+    ~BasicOrderBook();
 
-    // Core operations
+    // Core operations. In a matching book an order that crosses trades
+    // against the opposite side before anything is inserted; only a limit
+    // GTC or GTT remainder rests. A killed FOK, an order rejected by the post-only
+    // or price band check, and the unfilled part of an IOC or market order,
+    // count as cancelled.
     void add_order(const Order& order);
     bool cancel_order(uint64_t order_id);
+
+    // new_quantity is the full size: displayed plus reserve for an iceberg.
+    // At the same price, a cut keeps queue priority and an increase moves
+    // the order to the back of its level. A new price also goes to the back
+    // of the new level; if that would cross a matching book the order is
+    // cancelled and re-added through the matcher. Either way a price amend
+    // counts as a cancel plus an add. A quantity of 0 cancels the order.
     bool amend_order(uint64_t order_id, double new_price, uint64_t new_quantity);
 
+    // Venue-reported changes for a mirrored (BookMode::Passive) book. Both
+    // remove the order once nothing is left; a matching book refuses
+    // execute_order (returns false), as it reports only its own trades, and
+    // an execution of 0 reports nothing. An execution fills at most the
+    // displayed slice; an iceberg whose slice fills cuts the next one and
+    // goes to the back of its level, as in a sweep. A partial cancel keeps
+    // queue priority and is taken from an iceberg's reserve first.
+    bool execute_order(uint64_t order_id, uint64_t quantity);  // Fill reported by the venue
+    bool reduce_order(uint64_t order_id, uint64_t quantity);   // Partial cancel
+
     // Query operations
     void get_snapshot(size_t depth, std::vector<PriceLevel>& bids, 
                       std::vector<PriceLevel>& asks) const;
     void print_book(size_t depth = 10) const;
 
+    // Per-operation latency percentiles. Recorded only when built with
+    // HFT_LATENCY_STATS (cmake -DHFT_LATENCY_STATS=ON); otherwise the timing
+    // code is compiled out and this prints a note.
+    void print_latency_stats() const;
+#ifdef HFT_LATENCY_STATS
+    const OrderBookLatency& latency_stats() const { return latency_; }
+    void reset_latency_stats() { latency_.reset(); }
+#endif
+
+    // Level change tracking (single consumer, e.g. an L2 publisher)
+    uint64_t level_version() const { return level_version_; }
+    void set_level_tracking(bool enabled);
+    bool level_tracking() const { return track_level_changes_; }
+    size_t drain_level_changes(std::vector<LevelUpdate>& updates);
+
     // Utility methods
     size_t bid_levels() const { return bids_.size(); }
     size_t ask_levels() const { return asks_.size(); }
@@ -170,11 +872,134 @@ public:
     uint64_t total_orders_cancelled() const { return total_orders_cancelled_; }
     uint64_t total_orders_matched() const { return total_orders_matched_; }
 
+    // Memory pool statistics and idle-time release
+    MemoryPoolStats pool_stats() const { return order_pool_.stats(); }
+    std::vector<MemoryPoolBlockOccupancy> pool_occupancy() const { return order_pool_.block_occupancy(); }
+    void set_pool_release_policy(const PoolReleasePolicy& policy) { pool_release_policy_ = policy; }
+    size_t on_idle();
+
+    BookMode mode() const { return mode_; }
+
+    // Matching policy parameters (e.g. LmmPolicy's participant and share);
+    // change them only between orders
+    Policy& policy() { return policy_; }
+    const Policy& policy() const { return policy_; }
+
+    // Copy of a resting order by id
+    bool get_order(uint64_t order_id, Order& order) const {
+        auto it = order_lookup_.find(order_id);
+        if (it == order_lookup_.end()) {
+            return false;
+        }
+        order = order_pool_[it->second].order;
+        return true;
+    }
+
+    // Visit resting orders: bids best first, then asks best first, each
+    // level in FIFO order
+    template<typename Visitor>
+    void for_each_order(Visitor&& visit) const {
+        for (const auto& [price, level_data] : bids_) {
+            for (PoolHandle h = level_data.head; h != kInvalidHandle; h = order_pool_[h].next) {
+                visit(order_pool_[h].order);
+            }
+        }
+        for (const auto& [price, level_data] : asks_) {
+            for (PoolHandle h = level_data.head; h != kInvalidHandle; h = order_pool_[h].next) {
+                visit(order_pool_[h].order);
+            }
+        }
+    }
+
+    // Trade reporting (nullptr restores the console print)
+    void set_trade_handler(TradeHandler handler, void* context) {
+        trade_handler_ = handler;
+        trade_context_ = context;
+    }
+
     // Get best bid/ask
     bool get_best_bid(double& price, uint64_t& quantity) const;
     bool get_best_ask(double& price, uint64_t& quantity) const;
+    const TopOfBook& best_bid() const { return best_bid_; }
+    const TopOfBook& best_ask() const { return best_ask_; }
+
+    // Stop orders (BookMode::Matching). `order` is what enters the book
+    // once a trade prints at or through `trigger_price`: OrderType::Market
+    // for a stop, a limit for a stop-limit. Stops only trigger on trades
+    // after they arrive. cancel_order() also cancels a pending stop; stops
+    // cannot be amended. Returns false for a duplicate id.
+    bool add_stop_order(const Order& order, double trigger_price);
+    size_t pending_stops() const { return stops_.size(); }
+
+    // Price grid (default 0.01): where post-only orders slide to, and how
+    // stop triggers are bucketed. Only while no stop is pending.
+    bool set_tick_size(double tick_size);
+    double tick_size() const { return stops_.tick_size(); }
+
+    // Price band (BookMode::Matching): a limit order priced more than `width`
+    // through the best opposite price is rejected on arrival, before it can
+    // trade, and a market order trades no further than that. Inactive while
+    // the opposite side is empty; an infinite width (the default) turns it off.
+    bool set_price_band(double width);
+    double price_band() const { return price_band_; }
 
-    // Clear the order book
+    // Call auction (BookMode::Matching), e.g. for the open and the close.
+    // begin_auction() starts the call phase: add_order() only accumulates,
+    // so the book may cross, and market, IOC, FOK and post-only orders are
+    // rejected since they cannot wait; the price band is not applied.
+    // Cancels, amends, stops and expiry work as usual.
+    //
+    // indicative_uncross() finds the clearing price without trading, with
+    // one pass over the levels in the crossed range. Among their prices it
+    // takes the one that
+    //   1. maximises the executable volume,
+    //   2. then leaves the smallest surplus |buy - sell|,
+    //   3. then, if the surplus is on the buy side at every price still
+    //      tied, the highest; on the sell side at every one, the lowest,
+    //   4. then is nearest reference_price (e.g. the previous close), the
+    //      lower on an equal distance or without a reference.
+    // uncross() executes there and returns to continuous matching. Both
+    // sides fill in price-time priority under every matching policy, an
+    // iceberg's displayed size before its reserve; self-trade prevention is
+    // not applied. Trades print at the clearing price and trigger stops as
+    // in continuous matching, and what is left rests uncrossed.
+    bool begin_auction();
+    bool in_auction() const { return auction_; }
+    AuctionResult indicative_uncross(
+        double reference_price = std::numeric_limits<double>::quiet_NaN()) const;
+    AuctionResult uncross(double reference_price = std::numeric_limits<double>::quiet_NaN());
+
+    // Engine clock for GTT orders (BookMode::Matching). A GTT order whose
+    // expire_ns is not after the clock is rejected on arrival; a resting one
+    // is cancelled, through cancel_order(), by the first advance_time() at or
+    // after its expire_ns, rounded up to the expiry resolution. The clock
+    // never moves backwards. Returns the number of orders expired. Pending
+    // stops do not expire until they trigger.
+    size_t advance_time(uint64_t now_ns);
+    uint64_t clock_ns() const { return clock_ns_; }
+    size_t pending_expiries() const { return expiries_.size(); }
+    // Timer granularity (default 1 us); only while no expiry is armed
+    bool set_expiry_resolution(uint64_t resolution_ns);
+
+    // Clear the order book (and pending stops and expiries; the clock and
+    // the auction phase stay)
     void clear();
+
+    // Binary snapshots (order_book_snapshot.cpp). `sequence` is stored with
+    // the image, e.g. the journal sequence it reflects, so recovery can
+    // replay only the journal tail.
+    bool save_snapshot(const std::string& path, uint64_t sequence = 0) const;
+    pid_t save_snapshot_async(const std::string& path, uint64_t sequence = 0) const;
+    static bool wait_snapshot(pid_t pid);
+    bool load_snapshot(const std::string& path, uint64_t* sequence = nullptr);
 };
 
+// Members are defined in order_book.cpp and order_book_snapshot.cpp and
+// instantiated there for these policies
+extern template class BasicOrderBook<FifoPolicy>;
+extern template class BasicOrderBook<ProRataPolicy>;
+extern template class BasicOrderBook<TopOrderProRataPolicy>;
+extern template class BasicOrderBook<LmmPolicy>;
+
+using OrderBook = BasicOrderBook<FifoPolicy>;
+
@@ -0,0 +1,467 @@
+#include "order_book.h"
+#include <cerrno>
+#include <climits>
+#include <cstddef>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// ============================================================================
+// Snapshot File Format
+// ============================================================================
+// Header, then every level (bids best first, then asks best first), each
+// followed by its orders in FIFO order and then by one SnapshotIceberg per
+// order in it that still has a reserve. Price and side live on the level
+// record only. Pending stops follow the last level, in trigger order, and
+// then one SnapshotExpiry per resting order with an armed GTT timer.
+// Version 2 added the iceberg records; in version 1 files both iceberg
+// counts are the reserved zeros, so those still load. Version 3 appended
+// stop_count to the header, and version 4 the clock, expiry_count and the
+// stops' expire_ns; older headers and stop records end just before them.
+// Version 5 appended the participant and STP mode to each order record
+// (stops keep theirs in bytes that were reserved zeros). The top-order
+// flag of a TopOrderProRataPolicy book uses a byte that was a reserved zero
+// in version 5. Version 6 appended the auction phase to the header: a book
+// saved in its call phase may be crossed, and loads back in it. Version 7
+// keeps a resting order's type (post-only) in another reserved byte of its
+// record, so older files load every order as a plain limit.
+namespace {
+
+constexpr uint64_t kSnapshotMagic = 0x48465450534E4150ull;  // "HFTPSNAP"
+constexpr uint32_t kSnapshotVersion = 7;
+
+struct SnapshotHeader {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t iceberg_count;
+    uint64_t sequence;
+    uint64_t order_count;
+    uint64_t bid_levels;
+    uint64_t ask_levels;
+    uint64_t total_orders_added;
+    uint64_t total_orders_cancelled;
+    uint64_t total_orders_matched;
+    uint64_t stop_count;
+    uint64_t clock_ns;
+    uint64_t expiry_count;
+    uint64_t auction;  // 1 in the call phase
+};
+
+struct SnapshotLevel {
+    double price;
+    uint32_t order_count;
+    uint32_t iceberg_count;
+};
+
+struct SnapshotOrder {
+    uint64_t order_id;
+    uint64_t quantity;  // Displayed
+    uint64_t timestamp_ns;
+    uint32_t participant_id;
+    StpMode stp;
+    uint8_t top;  // Holds top-order priority at its level
+    OrderType type;
+    uint8_t reserved;
+};
+
+struct SnapshotIceberg {
+    uint64_t order_id;
+    uint64_t display_quantity;
+    uint64_t hidden_quantity;
+};
+
+struct SnapshotStop {
+    uint64_t order_id;
+    double price;  // Limit price of a stop-limit
+    uint64_t quantity;
+    uint64_t timestamp_ns;
+    uint64_t display_quantity;
+    double trigger_price;
+    uint8_t is_buy;
+    OrderType type;
+    TimeInForce tif;
+    StpMode stp;
+    uint32_t participant_id;
+    uint64_t expire_ns;
+};
+
+struct SnapshotExpiry {
+    uint64_t order_id;
+    uint64_t expire_ns;
+};
+
+size_t header_size(uint32_t version) {
+    return version >= 6 ? sizeof(SnapshotHeader)
+         : version >= 4 ? offsetof(SnapshotHeader, auction)
+         : version == 3 ? offsetof(SnapshotHeader, clock_ns)
+                        : offsetof(SnapshotHeader, stop_count);
+}
+
+size_t order_size(uint32_t version) {
+    return version >= 5 ? sizeof(SnapshotOrder) : offsetof(SnapshotOrder, participant_id);
+}
+
+size_t stop_size(uint32_t version) {
+    return version >= 4 ? sizeof(SnapshotStop) : offsetof(SnapshotStop, expire_ns);
+}
+
+// Buffered writer on a raw fd with a fixed buffer: no heap allocation, so
+// it is safe to run in a child forked from a multithreaded process
+class RawWriter {
+private:
+    int fd_;
+    bool ok_;
+    size_t used_;
+    uint8_t buffer_[1 << 16];
+
+public:
+    explicit RawWriter(int fd) : fd_(fd), ok_(fd >= 0), used_(0) {}
+
+    void put(const void* data, size_t size) {
+        if (used_ + size > sizeof(buffer_)) {
+            flush();
+        }
+        std::memcpy(buffer_ + used_, data, size);
+        used_ += size;
+    }
+
+    void flush() {
+        const uint8_t* p = buffer_;
+        while (ok_ && used_ > 0) {
+            ssize_t n = ::write(fd_, p, used_);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                ok_ = false;
+                break;
+            }
+            p += n;
+            used_ -= static_cast<size_t>(n);
+        }
+        used_ = 0;
+    }
+
+    bool ok() const { return ok_; }
+};
+
+}  // namespace
+
+// ============================================================================
+// Save Snapshot
+// ============================================================================
+template<typename Policy>
+bool BasicOrderBook<Policy>::save_snapshot(const std::string& path, uint64_t sequence) const {
+    // Write under a temporary name and rename, so a crash never leaves a
+    // half-written file under the real name. Fixed buffers only: this also
+    // runs in the forked child, where malloc may be locked by another thread.
+    char tmp_path[PATH_MAX];
+    if (path.size() + 5 > sizeof(tmp_path)) {
+        return false;
+    }
+    std::memcpy(tmp_path, path.c_str(), path.size());
+    std::memcpy(tmp_path + path.size(), ".tmp", 5);
+
+    int fd = ::open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    RawWriter out(fd);
+
+    SnapshotHeader header{};
+    header.magic = kSnapshotMagic;
+    header.version = kSnapshotVersion;
+    header.sequence = sequence;
+    header.order_count = order_pool_.live_count();
+    header.bid_levels = bids_.size();
+    header.ask_levels = asks_.size();
+    header.total_orders_added = total_orders_added_;
+    header.total_orders_cancelled = total_orders_cancelled_;
+    header.total_orders_matched = total_orders_matched_;
+    header.stop_count = stops_.size();
+    header.clock_ns = clock_ns_;
+    header.expiry_count = expiries_.size();
+    header.auction = auction_ ? 1 : 0;
+
+    // Icebergs with a reserve are rare; only levels holding one are walked
+    // twice, to count them
+    auto count_icebergs = [&](const PriceLevelData& level) {
+        uint32_t count = 0;
+        if (level.hidden_quantity > 0) {
+            for (PoolHandle h = level.head; h != kInvalidHandle; h = order_pool_[h].next) {
+                count += order_pool_[h].order.hidden_quantity > 0 ? 1u : 0u;
+            }
+        }
+        return count;
+    };
+    for (const auto& [price, level_data] : bids_) {
+        header.iceberg_count += count_icebergs(level_data);
+    }
+    for (const auto& [price, level_data] : asks_) {
+        header.iceberg_count += count_icebergs(level_data);
+    }
+    out.put(&header, sizeof(header));
+
+    auto write_level = [&](const PriceLevelData& level) {
+        SnapshotLevel record{level.price, level.order_count, count_icebergs(level)};
+        out.put(&record, sizeof(record));
+        for (PoolHandle h = level.head; h != kInvalidHandle; h = order_pool_[h].next) {
+            const Order& order = order_pool_[h].order;
+            SnapshotOrder entry{order.order_id, order.quantity, order.timestamp_ns,
+                                order.participant_id, order.stp,
+                                static_cast<uint8_t>(level.top == h ? 1 : 0), order.type, 0};
+            out.put(&entry, sizeof(entry));
+        }
+        if (record.iceberg_count == 0) {
+            return;
+        }
+        for (PoolHandle h = level.head; h != kInvalidHandle; h = order_pool_[h].next) {
+            const Order& order = order_pool_[h].order;
+            if (order.hidden_quantity > 0) {
+                SnapshotIceberg entry{order.order_id, order.display_quantity, order.hidden_quantity};
+                out.put(&entry, sizeof(entry));
+            }
+        }
+    };
+    for (const auto& [price, level_data] : bids_) {
+        write_level(level_data);
+    }
+    for (const auto& [price, level_data] : asks_) {
+        write_level(level_data);
+    }
+    stops_.for_each([&](const Order& order, double trigger_price) {
+        SnapshotStop entry{order.order_id, order.price, order.quantity, order.timestamp_ns,
+                           order.display_quantity, trigger_price,
+                           static_cast<uint8_t>(order.is_buy ? 1 : 0), order.type, order.tif, order.stp,
+                           order.participant_id, order.expire_ns};
+        out.put(&entry, sizeof(entry));
+    });
+    auto write_expiries = [&](const PriceLevelData& level) {
+        for (PoolHandle h = level.head; h != kInvalidHandle; h = order_pool_[h].next) {
+            if (order_pool_[h].timer != kInvalidHandle) {
+                SnapshotExpiry entry{order_pool_[h].order.order_id, order_pool_[h].order.expire_ns};
+                out.put(&entry, sizeof(entry));
+            }
+        }
+    };
+    if (header.expiry_count > 0) {
+        for (const auto& [price, level_data] : bids_) {
+            write_expiries(level_data);
+        }
+        for (const auto& [price, level_data] : asks_) {
+            write_expiries(level_data);
+        }
+    }
+
+    out.flush();
+    bool ok = out.ok() && ::fdatasync(fd) == 0;
+    ok = ::close(fd) == 0 && ok;
+    if (ok) {
+        ok = ::rename(tmp_path, path.c_str()) == 0;
+    } else {
+        ::unlink(tmp_path);
+    }
+    return ok;
+}
+
+// Copy-on-write snapshot: the forked child sees the book frozen at fork
+// time and writes it out while the parent keeps matching. Returns the
+// child's pid, or -1 if fork failed.
+template<typename Policy>
+pid_t BasicOrderBook<Policy>::save_snapshot_async(const std::string& path, uint64_t sequence) const {
+    pid_t pid = ::fork();
+    if (pid == 0) {
+        bool ok = save_snapshot(path, sequence);
+        ::_exit(ok ? 0 : 1);
+    }
+    return pid;
+}
+
+template<typename Policy>
+bool BasicOrderBook<Policy>::wait_snapshot(pid_t pid) {
+    if (pid <= 0) {
+        return false;
+    }
+    int status = 0;
+    while (::waitpid(pid, &status, 0) < 0) {
+        if (errno != EINTR) return false;
+    }
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+// ============================================================================
+// Load Snapshot (bulk restore, bypasses add_order)
+// ============================================================================
+template<typename Policy>
+bool BasicOrderBook<Policy>::load_snapshot(const std::string& path, uint64_t* sequence) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < header_size(1)) {
+        ::close(fd);
+        return false;
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+    void* map = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        return false;
+    }
+    ::madvise(map, size, MADV_SEQUENTIAL);
+
+    const uint8_t* p = static_cast<const uint8_t*>(map);
+    const uint8_t* end = p + size;
+    SnapshotHeader header{};
+    std::memcpy(&header, p, header_size(1));
+    if (size >= header_size(header.version)) {
+        std::memcpy(&header, p, header_size(header.version));
+    }
+    p += header_size(header.version);
+
+    size_t expected = header_size(header.version)
+                    + (header.bid_levels + header.ask_levels) * sizeof(SnapshotLevel)
+                    + header.order_count * order_size(header.version)
+                    + header.iceberg_count * sizeof(SnapshotIceberg)
+                    + header.stop_count * stop_size(header.version)
+                    + header.expiry_count * sizeof(SnapshotExpiry);
+    if (header.magic != kSnapshotMagic || header.version < 1 || header.version > kSnapshotVersion ||
+        expected != size) {
+        ::munmap(map, size);
+        return false;
+    }
+
+    clear();
+    order_lookup_.reserve(header.order_count);
+
+    const size_t record_size = order_size(header.version);
+
+    // Levels arrive in map order, so every insert is an O(1) hinted append
+    auto load_level = [&](auto& side, bool is_buy) {
+        SnapshotLevel record;
+        if (static_cast<size_t>(end - p) < sizeof(record)) return false;
+        std::memcpy(&record, p, sizeof(record));
+        p += sizeof(record);
+        if (record.order_count == 0 ||
+            static_cast<size_t>(end - p) / record_size < record.order_count) {
+            return false;
+        }
+
+        auto it = side.emplace_hint(side.end(), std::piecewise_construct,
+                                    std::forward_as_tuple(record.price),
+                                    std::forward_as_tuple(record.price));
+        PriceLevelData& level = it->second;
+        touch_level(level, is_buy);
+        for (uint32_t i = 0; i < record.order_count; ++i) {
+            SnapshotOrder entry{};
+            std::memcpy(&entry, p, record_size);
+            p += record_size;
+
+            PoolHandle handle = order_pool_.allocate();
+            Order& order = order_pool_[handle].order;
+            order = Order(entry.order_id, is_buy, record.price, entry.quantity, entry.timestamp_ns);
+            order.participant_id = entry.participant_id;
+            order.stp = entry.stp;
+            order.type = entry.type;  // A reserved zero (Limit) before version 7
+            order_pool_[handle].timer = kInvalidHandle;
+            push_back(level, handle);
+            if constexpr (Policy::kTopOrder) {
+                if (entry.top != 0) {
+                    level.top = handle;
+                }
+            }
+            level.total_quantity += entry.quantity;
+            order_lookup_.emplace(entry.order_id, handle);
+        }
+
+        if (static_cast<size_t>(end - p) / sizeof(SnapshotIceberg) < record.iceberg_count) {
+            return false;
+        }
+        for (uint32_t i = 0; i < record.iceberg_count; ++i) {
+            SnapshotIceberg entry;
+            std::memcpy(&entry, p, sizeof(entry));
+            p += sizeof(entry);
+
+            auto found = order_lookup_.find(entry.order_id);
+            if (found == order_lookup_.end()) return false;
+            Order& order = order_pool_[found->second].order;
+            order.display_quantity = entry.display_quantity;
+            order.hidden_quantity = entry.hidden_quantity;
+            level.hidden_quantity += entry.hidden_quantity;
+        }
+        return true;
+    };
+
+    bool ok = true;
+    for (uint64_t i = 0; ok && i < header.bid_levels; ++i) {
+        ok = load_level(bids_, true);
+    }
+    for (uint64_t i = 0; ok && i < header.ask_levels; ++i) {
+        ok = load_level(asks_, false);
+    }
+    for (uint64_t i = 0; ok && i < header.stop_count; ++i) {
+        SnapshotStop entry{};
+        std::memcpy(&entry, p, stop_size(header.version));
+        p += stop_size(header.version);
+
+        Order order(entry.order_id, entry.is_buy != 0, entry.price, entry.quantity,
+                    entry.timestamp_ns, entry.type, entry.tif);
+        order.display_quantity = entry.display_quantity;
+        order.expire_ns = entry.expire_ns;
+        order.participant_id = entry.participant_id;
+        order.stp = entry.stp;
+        ok = order_lookup_.count(entry.order_id) == 0 && stops_.add(order, entry.trigger_price);
+    }
+
+    // Timers are re-armed against the snapshot's clock
+    if (header.version >= 4) {
+        clock_ns_ = header.clock_ns;
+        expiries_.clear(clock_ns_ / expiry_resolution_ns_);
+    }
+    for (uint64_t i = 0; ok && i < header.expiry_count; ++i) {
+        SnapshotExpiry entry;
+        std::memcpy(&entry, p, sizeof(entry));
+        p += sizeof(entry);
+
+        auto found = order_lookup_.find(entry.order_id);
+        ok = found != order_lookup_.end();
+        if (ok) {
+            OrderNode& node = order_pool_[found->second];
+            node.order.tif = TimeInForce::Gtt;
+            node.order.expire_ns = entry.expire_ns;
+            node.timer = expiries_.arm(expiry_tick(entry.expire_ns), found->second);
+        }
+    }
+    ::munmap(map, size);
+    if (!ok) {
+        clear();
+        return false;
+    }
+
+    total_orders_added_ = header.total_orders_added;
+    total_orders_cancelled_ = header.total_orders_cancelled;
+    total_orders_matched_ = header.total_orders_matched;
+    auction_ = header.auction != 0;
+    refresh_best_bid();
+    refresh_best_ask();
+
+    if (sequence) {
+        *sequence = header.sequence;
+    }
+    return true;
+}
+
+// The class itself is instantiated in order_book.cpp; these members are
+// defined here
+#define INSTANTIATE_SNAPSHOT(Policy)                                                             \
+    template bool BasicOrderBook<Policy>::save_snapshot(const std::string&, uint64_t) const;     \
+    template pid_t BasicOrderBook<Policy>::save_snapshot_async(const std::string&, uint64_t) const; \
+    template bool BasicOrderBook<Policy>::wait_snapshot(pid_t);                                  \
+    template bool BasicOrderBook<Policy>::load_snapshot(const std::string&, uint64_t*);
+
+INSTANTIATE_SNAPSHOT(FifoPolicy)
+INSTANTIATE_SNAPSHOT(ProRataPolicy)
+INSTANTIATE_SNAPSHOT(TopOrderProRataPolicy)
+INSTANTIATE_SNAPSHOT(LmmPolicy)
+#undef INSTANTIATE_SNAPSHOT
@@ -0,0 +1,179 @@
+#include "order_flow.h"
+#include <cstdio>
+#include <cstring>
+#include <random>
+
+namespace {
+
+constexpr uint64_t kFnvPrime = 1099511628211ull;
+
+void fnv_mix(uint64_t& hash, uint64_t value) {
+    for (int i = 0; i < 8; ++i) {
+        hash ^= (value >> (i * 8)) & 0xFF;
+        hash *= kFnvPrime;
+    }
+}
+
+uint64_t price_bits(double price) {
+    uint64_t bits;
+    std::memcpy(&bits, &price, sizeof(bits));
+    return bits;
+}
+
+}  // namespace
+
+// ============================================================================
+// Generator
+// ============================================================================
+void generate_order_flow(const OrderFlowConfig& config, std::vector<JournalRecord>& out) {
+    struct LiveOrder {
+        uint64_t order_id;
+        bool is_buy;
+        double price;
+    };
+
+    std::mt19937 gen(config.seed);
+    const uint32_t total_weight = config.add_weight + config.cancel_weight +
+                                  config.amend_weight + config.aggressive_weight;
+    std::uniform_int_distribution<uint32_t> action_dist(0, total_weight > 0 ? total_weight - 1 : 0);
+    std::uniform_int_distribution<int64_t> tick_dist(1, config.max_ticks);
+    std::uniform_int_distribution<int64_t> cross_dist(0, config.aggressive_ticks);
+    std::uniform_int_distribution<uint64_t> qty_dist(1, 1000);
+
+    auto passive_price = [&](bool is_buy) {
+        double offset = static_cast<double>(tick_dist(gen)) * config.tick;
+        return is_buy ? config.mid - offset : config.mid + offset;
+    };
+
+    // Ids the generator has issued and not cancelled. Some will have been
+    // filled by the book, so a cancel or amend may be rejected on replay;
+    // that is part of the flow.
+    std::vector<LiveOrder> live;
+    live.reserve(config.max_live);
+    uint64_t next_id = 1;
+
+    out.clear();
+    out.reserve(config.num_messages);
+    for (uint64_t seq = 1; seq <= config.num_messages; ++seq) {
+        JournalRecord record{};
+        record.seq = seq;
+        record.timestamp_ns = seq;
+        uint32_t action = action_dist(gen);
+
+        bool want_add = action < config.add_weight;
+        bool want_aggressive = !want_add &&
+            action >= total_weight - config.aggressive_weight;
+        if (live.empty() || (want_add && live.size() < config.max_live)) {
+            want_add = true;
+            want_aggressive = false;
+        } else if (want_add) {
+            want_add = false;  // Book is at its steady size: cancel instead
+            action = config.add_weight;
+        }
+
+        if (want_add || want_aggressive) {
+            bool is_buy = (gen() & 1) == 0;
+            record.op = JournalOp::Add;
+            record.order_id = next_id++;
+            record.is_buy = is_buy ? 1 : 0;
+            record.quantity = qty_dist(gen);
+            if (want_aggressive) {
+                double through = static_cast<double>(cross_dist(gen)) * config.tick;
+                record.price = is_buy ? config.mid + through : config.mid - through;
+            } else {
+                record.price = passive_price(is_buy);
+            }
+            if (live.size() < config.max_live) {
+                live.push_back({record.order_id, is_buy, record.price});
+            }
+        } else {
+            size_t idx = static_cast<size_t>(gen() % live.size());
+            LiveOrder& order = live[idx];
+            record.order_id = order.order_id;
+            if (action < config.add_weight + config.cancel_weight) {
+                record.op = JournalOp::Cancel;
+                live[idx] = live.back();
+                live.pop_back();
+            } else {
+                record.op = JournalOp::Amend;
+                record.quantity = qty_dist(gen);
+                // Amends carry the full new price; half of them move it
+                if (gen() & 1) {
+                    order.price = passive_price(order.is_buy);
+                }
+                record.price = order.price;
+            }
+        }
+        record.checksum = Journal::checksum(record);
+        out.push_back(record);
+    }
+}
+
+// ============================================================================
+// Capture files
+// ============================================================================
+bool write_order_flow_file(const std::string& path, const std::vector<JournalRecord>& records) {
+    FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) {
+        return false;
+    }
+    JournalFileHeader header = Journal::file_header();
+    bool ok = std::fwrite(&header, sizeof(header), 1, f) == 1 &&
+              std::fwrite(records.data(), sizeof(JournalRecord), records.size(), f) == records.size();
+    return std::fclose(f) == 0 && ok;
+}
+
+bool read_order_flow_file(const std::string& path, std::vector<JournalRecord>& records) {
+    FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) {
+        return false;
+    }
+    std::fseek(f, 0, SEEK_END);
+    long size = std::ftell(f);
+    std::fseek(f, 0, SEEK_SET);
+    JournalFileHeader header{};
+    if (size < static_cast<long>(sizeof(header)) || std::fread(&header, sizeof(header), 1, f) != 1 ||
+        !Journal::valid_header(header)) {
+        std::fclose(f);
+        return false;
+    }
+    records.resize((static_cast<size_t>(size) - sizeof(header)) / sizeof(JournalRecord));
+    size_t read = std::fread(records.data(), sizeof(JournalRecord), records.size(), f);
+    std::fclose(f);
+    records.resize(read);
+
+    for (size_t i = 0; i < records.size(); ++i) {
+        if (records[i].seq != i + 1 || records[i].checksum != Journal::checksum(records[i])) {
+            records.resize(i);
+            break;
+        }
+    }
+    return true;
+}
+
+// ============================================================================
+// Regression Hashes
+// ============================================================================
+uint64_t hash_book(const OrderBook& book) {
+    uint64_t hash = 14695981039346656037ull;
+    book.for_each_order([&](const Order& order) {
+        fnv_mix(hash, order.order_id);
+        fnv_mix(hash, order.is_buy ? 1 : 0);
+        fnv_mix(hash, price_bits(order.price));
+        fnv_mix(hash, order.quantity);
+        if (order.hidden_quantity > 0) {
+            fnv_mix(hash, order.hidden_quantity);  // Icebergs only, so plain books hash as before
+        }
+    });
+    return hash;
+}
+
+void TradeHash::on_trade(const Trade& trade, void* context) {
+    auto* self = static_cast<TradeHash*>(context);
+    fnv_mix(self->value, trade.buy_order_id);
+    fnv_mix(self->value, trade.sell_order_id);
+    fnv_mix(self->value, price_bits(trade.price));
+    fnv_mix(self->value, trade.quantity);
+    self->trades++;
+    self->quantity += trade.quantity;
+}
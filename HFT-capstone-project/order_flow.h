@@ -0,0 +1,93 @@
+#pragma once
+
+#include "order_book.h"
+#include "journal.h"
+#include <string>
+
+// ============================================================================
+// Deterministic Order Flow (capture / replay)
+// ============================================================================
+// A capture is a sequence of JournalRecords in the journal file format, so a
+// generated capture and a production journal replay the same way. The
+// generator is fully determined by its config: the same seed gives the same
+// file, the same book and the same trades on every run.
+struct OrderFlowConfig {
+    uint32_t seed = 42;
+    size_t num_messages = 1000000;
+
+    // Relative weights of each input kind
+    uint32_t add_weight = 55;         // Passive add, 1..max_ticks away from the mid
+    uint32_t cancel_weight = 25;
+    uint32_t amend_weight = 10;       // Half quantity-only, half price moves
+    uint32_t aggressive_weight = 10;  // Add priced through the mid; crosses a fresh book
+
+    size_t max_live = 10000;          // Adds turn into cancels above this many known ids
+    int64_t max_ticks = 50;
+    int64_t aggressive_ticks = 5;     // How far through the mid an aggressive add reaches
+    double mid = 100.0;
+    double tick = 0.01;
+};
+
+void generate_order_flow(const OrderFlowConfig& config, std::vector<JournalRecord>& out);
+
+bool write_order_flow_file(const std::string& path, const std::vector<JournalRecord>& records);
+
+// Reads a capture or journal, stopping at the first torn or corrupt record.
+// Returns false if the file header is missing or unsupported.
+bool read_order_flow_file(const std::string& path, std::vector<JournalRecord>& records);
+
+// Apply one captured input to a book; returns whether the book accepted it
+inline bool apply_order_flow(OrderBook& book, const JournalRecord& record) {
+    switch (record.op) {
+        case JournalOp::Add: {
+            Order order(record.order_id, record.is_buy != 0, record.price,
+                        record.quantity, record.timestamp_ns, record.order_type, record.tif);
+            order.display_quantity = record.display_quantity;
+            order.expire_ns = record.expire_ns;
+            order.participant_id = record.participant_id;
+            order.stp = record.stp;
+            book.add_order(order);
+            return true;
+        }
+        case JournalOp::AddStop: {
+            Order order(record.order_id, record.is_buy != 0, record.price,
+                        record.quantity, record.timestamp_ns, record.order_type, record.tif);
+            order.display_quantity = record.display_quantity;
+            order.expire_ns = record.expire_ns;
+            order.participant_id = record.participant_id;
+            order.stp = record.stp;
+            return book.add_stop_order(order, record.trigger_price);
+        }
+        case JournalOp::Cancel:
+            return book.cancel_order(record.order_id);
+        case JournalOp::Amend:
+            return book.amend_order(record.order_id, record.price, record.quantity);
+        case JournalOp::Clock:
+            book.advance_time(record.timestamp_ns);
+            return true;
+        case JournalOp::AuctionStart:
+            return book.begin_auction();
+        case JournalOp::Uncross:
+            book.uncross(record.price);
+            return true;
+    }
+    return false;
+}
+
+// ============================================================================
+// Regression Hashes
+// ============================================================================
+// FNV-1a over every resting order (bids then asks, best first, FIFO within
+// a level): id, side, price bits, quantity and any iceberg reserve.
+// Timestamps are excluded.
+uint64_t hash_book(const OrderBook& book);
+
+// Running FNV-1a over the trade stream. Install with
+// book.set_trade_handler(&TradeHash::on_trade, &hash).
+struct TradeHash {
+    uint64_t value = 14695981039346656037ull;
+    uint64_t trades = 0;
+    uint64_t quantity = 0;
+
+    static void on_trade(const Trade& trade, void* context);
+};
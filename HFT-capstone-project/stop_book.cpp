@@ -0,0 +1,151 @@
+#include "order_book.h"
+
+// ============================================================================
+// Constructor
+// ============================================================================
+StopBook::StopBook(double tick_size)
+    : buy_trigger_(std::numeric_limits<int64_t>::max())
+    , sell_trigger_(std::numeric_limits<int64_t>::min())
+    , buy_threshold_(std::numeric_limits<double>::infinity())
+    , sell_threshold_(-std::numeric_limits<double>::infinity())
+    , tick_size_(tick_size) {
+}
+
+bool StopBook::set_tick_size(double tick_size) {
+    if (!empty() || !(tick_size > 0.0)) {
+        return false;
+    }
+    tick_size_ = tick_size;
+    return true;
+}
+
+// ============================================================================
+// Add / Cancel
+// ============================================================================
+bool StopBook::add(const Order& order, double trigger_price) {
+    if (lookup_.count(order.order_id) != 0) {
+        return false;
+    }
+
+    PoolHandle handle = pool_.allocate();
+    StopNode& node = pool_[handle];
+    node.order = order;
+    node.trigger = to_ticks(trigger_price);
+    node.next = kInvalidHandle;
+
+    Bucket& bucket = order.is_buy ? buy_stops_[node.trigger] : sell_stops_[node.trigger];
+    node.prev = bucket.tail;
+    if (bucket.tail != kInvalidHandle) {
+        pool_[bucket.tail].next = handle;
+    } else {
+        bucket.head = handle;
+    }
+    bucket.tail = handle;
+    lookup_.emplace(order.order_id, handle);
+
+    if (order.is_buy ? node.trigger < buy_trigger_ : node.trigger > sell_trigger_) {
+        refresh_triggers();
+    }
+    return true;
+}
+
+bool StopBook::cancel(uint64_t order_id) {
+    auto lookup_it = lookup_.find(order_id);
+    if (lookup_it == lookup_.end()) {
+        return false;
+    }
+
+    PoolHandle handle = lookup_it->second;
+    StopNode& node = pool_[handle];
+    bool is_buy = node.order.is_buy;
+    auto unlink = [&](Bucket& bucket) {
+        if (node.prev != kInvalidHandle) {
+            pool_[node.prev].next = node.next;
+        } else {
+            bucket.head = node.next;
+        }
+        if (node.next != kInvalidHandle) {
+            pool_[node.next].prev = node.prev;
+        } else {
+            bucket.tail = node.prev;
+        }
+        return bucket.head == kInvalidHandle;
+    };
+
+    if (is_buy) {
+        auto it = buy_stops_.find(node.trigger);
+        if (unlink(it->second)) buy_stops_.erase(it);
+    } else {
+        auto it = sell_stops_.find(node.trigger);
+        if (unlink(it->second)) sell_stops_.erase(it);
+    }
+    lookup_.erase(lookup_it);
+    pool_.deallocate(handle);
+    refresh_triggers();
+    return true;
+}
+
+// ============================================================================
+// Trigger
+// ============================================================================
+size_t StopBook::collect(double low, double high, std::vector<Order>& out) {
+    size_t before = out.size();
+    int64_t high_ticks = to_ticks(high);
+    int64_t low_ticks = to_ticks(low);
+
+    // Buckets are ordered nearest first, so the triggered ones are a prefix
+    if (high_ticks >= buy_trigger_) {
+        drain(buy_stops_, buy_stops_.upper_bound(high_ticks), out);
+    }
+    if (low_ticks <= sell_trigger_) {
+        drain(sell_stops_, sell_stops_.upper_bound(low_ticks), out);
+    }
+    refresh_triggers();
+    return out.size() - before;
+}
+
+// Move every stop in buckets [begin, last) to `out`, then drop the buckets
+template<typename Buckets>
+void StopBook::drain(Buckets& buckets, typename Buckets::iterator last, std::vector<Order>& out) {
+    for (auto it = buckets.begin(); it != last; ++it) {
+        PoolHandle handle = it->second.head;
+        while (handle != kInvalidHandle) {
+            PoolHandle next = pool_[handle].next;
+            out.push_back(pool_[handle].order);
+            lookup_.erase(pool_[handle].order.order_id);
+            pool_.deallocate(handle);
+            handle = next;
+        }
+    }
+    buckets.erase(buckets.begin(), last);
+}
+
+void StopBook::refresh_triggers() {
+    if (buy_stops_.empty()) {
+        buy_trigger_ = std::numeric_limits<int64_t>::max();
+        buy_threshold_ = std::numeric_limits<double>::infinity();
+    } else {
+        buy_trigger_ = buy_stops_.begin()->first;
+        buy_threshold_ = (static_cast<double>(buy_trigger_) - 0.5) * tick_size_;
+    }
+    if (sell_stops_.empty()) {
+        sell_trigger_ = std::numeric_limits<int64_t>::min();
+        sell_threshold_ = -std::numeric_limits<double>::infinity();
+    } else {
+        sell_trigger_ = sell_stops_.begin()->first;
+        sell_threshold_ = (static_cast<double>(sell_trigger_) + 0.5) * tick_size_;
+    }
+}
+
+// ============================================================================
+// Clear
+// ============================================================================
+void StopBook::clear() {
+    for (const auto& [id, handle] : lookup_) {
+        pool_.deallocate(handle);
+    }
+    lookup_.clear();
+    buy_stops_.clear();
+    sell_stops_.clear();
+    refresh_triggers();
+}
@@ -0,0 +1,185 @@
+#include "order_book.h"
+#include <cstring>
+
+// ============================================================================
+// Constructor
+// ============================================================================
+TimerWheel::TimerWheel(uint64_t now_tick)
+    : now_(now_tick)
+    , size_(0) {
+    std::memset(occupied_, 0, sizeof(occupied_));
+}
+
+// ============================================================================
+// Arm / Cancel
+// ============================================================================
+PoolHandle TimerWheel::arm(uint64_t expire_tick, uint64_t payload) {
+    PoolHandle handle = pool_.allocate();
+    TimerNode& node = pool_[handle];
+    node.payload = payload;
+    node.expire = std::max(expire_tick, now_ + 1);
+    link(handle);
+    size_++;
+    return handle;
+}
+
+void TimerWheel::cancel(PoolHandle timer) {
+    unlink(timer);
+    pool_.deallocate(timer);
+    size_--;
+}
+
+// ============================================================================
+// Advance
+// ============================================================================
+size_t TimerWheel::advance(uint64_t tick, std::vector<uint64_t>& expired) {
+    size_t before = expired.size();
+    while (size_ > 0) {
+        uint64_t t = next_event();
+        if (t > tick) {
+            break;
+        }
+        now_ = t;
+
+        // Cascade every level whose index rolled over at t, highest first,
+        // so timers trickle down to the level that now covers them
+        int top = 0;
+        while (top + 1 < kLevels && (t & ((uint64_t{1} << (kSlotBits * (top + 1))) - 1)) == 0) {
+            ++top;
+        }
+        for (int level = top; level >= 1; --level) {
+            size_t index = (t >> (kSlotBits * level)) & (kSlots - 1);
+            PoolHandle handle = detach(static_cast<uint32_t>(static_cast<size_t>(level) * kSlots + index));
+            while (handle != kInvalidHandle) {
+                PoolHandle next = pool_[handle].next;
+                link(handle);
+                handle = next;
+            }
+        }
+
+        // Everything left in the level-0 slot for t is due now
+        PoolHandle handle = detach(static_cast<uint32_t>(t & (kSlots - 1)));
+        while (handle != kInvalidHandle) {
+            PoolHandle next = pool_[handle].next;
+            expired.push_back(pool_[handle].payload);
+            pool_.deallocate(handle);
+            size_--;
+            handle = next;
+        }
+    }
+    now_ = std::max(now_, tick);
+    return expired.size() - before;
+}
+
+// The next tick at which a slot must be processed. Within the current
+// rotation of a level that is its next occupied slot; a level holding only
+// slots at or behind its index (the next rotation) is next visited when the
+// level above rolls over.
+uint64_t TimerWheel::next_event() const {
+    for (int level = 0; level < kLevels; ++level) {
+        int shift = kSlotBits * level;
+        size_t index = (now_ >> shift) & (kSlots - 1);
+        int slot = next_occupied(level, index + 1);
+        uint64_t rotation = (now_ >> (shift + kSlotBits)) << (shift + kSlotBits);
+        if (slot >= 0) {
+            return rotation | (static_cast<uint64_t>(slot) << shift);
+        }
+        if (next_occupied(level, 0) >= 0) {
+            return rotation + (uint64_t{1} << (shift + kSlotBits));
+        }
+    }
+    return std::numeric_limits<uint64_t>::max();
+}
+
+// ============================================================================
+// Slot Helpers
+// ============================================================================
+// Place a timer by its distance from now: the lowest level that spans it,
+// in the slot its expiry maps to. Past the top level's span it waits in
+// the furthest top-level slot.
+void TimerWheel::link(PoolHandle handle) {
+    TimerNode& node = pool_[handle];
+    uint64_t at = node.expire;
+    uint64_t delta = at > now_ ? at - now_ : 0;
+    int level = 0;
+    while (level + 1 < kLevels && delta >= (uint64_t{1} << (kSlotBits * (level + 1)))) {
+        ++level;
+    }
+    uint64_t span = uint64_t{1} << (kSlotBits * kLevels);
+    if (delta >= span) {
+        at = now_ + span - 1;
+    }
+    size_t index = (at >> (kSlotBits * level)) & (kSlots - 1);
+    node.slot = static_cast<uint32_t>(static_cast<size_t>(level) * kSlots + index);
+
+    Slot& slot = slots_[node.slot];
+    node.prev = slot.tail;
+    node.next = kInvalidHandle;
+    if (slot.tail != kInvalidHandle) {
+        pool_[slot.tail].next = handle;
+    } else {
+        slot.head = handle;
+        occupied_[level][index / 64] |= uint64_t{1} << (index % 64);
+    }
+    slot.tail = handle;
+}
+
+void TimerWheel::unlink(PoolHandle handle) {
+    TimerNode& node = pool_[handle];
+    Slot& slot = slots_[node.slot];
+    if (node.prev != kInvalidHandle) {
+        pool_[node.prev].next = node.next;
+    } else {
+        slot.head = node.next;
+    }
+    if (node.next != kInvalidHandle) {
+        pool_[node.next].prev = node.prev;
+    } else {
+        slot.tail = node.prev;
+    }
+    if (slot.head == kInvalidHandle) {
+        size_t index = node.slot % kSlots;
+        occupied_[node.slot / kSlots][index / 64] &= ~(uint64_t{1} << (index % 64));
+    }
+}
+
+// Empty a slot and return its former list (still linked through next)
+PoolHandle TimerWheel::detach(uint32_t slot) {
+    PoolHandle head = slots_[slot].head;
+    slots_[slot] = Slot{};
+    size_t index = slot % kSlots;
+    occupied_[slot / kSlots][index / 64] &= ~(uint64_t{1} << (index % 64));
+    return head;
+}
+
+// First occupied slot of `level` at or after `from`, or -1
+int TimerWheel::next_occupied(int level, size_t from) const {
+    for (size_t word = from / 64; word < kSlots / 64; ++word) {
+        uint64_t bits = occupied_[level][word];
+        if (word == from / 64) {
+            bits &= ~uint64_t{0} << (from % 64);
+        }
+        if (bits != 0) {
+            return static_cast<int>(word * 64) + __builtin_ctzll(bits);
+        }
+    }
+    return -1;
+}
+
+// ============================================================================
+// Clear
+// ============================================================================
+void TimerWheel::clear(uint64_t now_tick) {
+    for (Slot& slot : slots_) {
+        PoolHandle handle = slot.head;
+        while (handle != kInvalidHandle) {
+            PoolHandle next = pool_[handle].next;
+            pool_.deallocate(handle);
+            handle = next;
+        }
+        slot = Slot{};
+    }
+    std::memset(occupied_, 0, sizeof(occupied_));
+    now_ = now_tick;
+    size_ = 0;
+}
@@ -0,0 +1,127 @@
+#include "trace.h"
+#include <chrono>
+#include <cstdio>
+
+const char* trace_stage_name(TraceStage stage) {
+    switch (stage) {
+        case TraceStage::Receive:   return "receive";
+        case TraceStage::Decode:    return "decode";
+        case TraceStage::Enqueue:   return "enqueue";
+        case TraceStage::Dequeue:   return "dequeue";
+        case TraceStage::BookApply: return "book apply";
+        case TraceStage::Publish:   return "publish";
+        default:                    return "?";
+    }
+}
+
+// ============================================================================
+// Constructor & Destructor
+// ============================================================================
+Tracer::Tracer(size_t queue_capacity)
+    : queue_(queue_capacity)
+    , running_(true)
+    , submitted_(0)
+    , aggregated_(0)
+    , dropped_(0) {
+    aggregator_ = std::thread(&Tracer::aggregator_loop, this);
+}
+
+Tracer::~Tracer() {
+    running_.store(false, std::memory_order_release);
+    aggregator_.join();
+}
+
+// ============================================================================
+// Aggregator Thread
+// ============================================================================
+void Tracer::aggregator_loop() {
+    uint32_t idle_spins = 0;
+    for (;;) {
+        TraceRecord record;
+        if (queue_.pop(record)) {
+            {
+                std::lock_guard<std::mutex> lock(histogram_mutex_);
+                aggregate(record);
+                // Drain what is already there under the same lock
+                size_t batch = 1;
+                while (batch < 256 && queue_.pop(record)) {
+                    aggregate(record);
+                    batch++;
+                }
+                aggregated_.fetch_add(batch, std::memory_order_release);
+            }
+            idle_spins = 0;
+            continue;
+        }
+
+        if (!running_.load(std::memory_order_acquire) && queue_.empty()) {
+            break;
+        }
+
+        // Idle: yield first, then sleep so the aggregator does not steal a
+        // pipeline thread's core
+        if (++idle_spins < 64) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+}
+
+void Tracer::aggregate(const TraceRecord& record) {
+    uint64_t first = 0;
+    uint64_t previous = 0;
+    for (size_t stage = 0; stage < kTraceStageCount; ++stage) {
+        uint64_t stamp = record.tsc[stage];
+        if (stamp == 0) continue;
+        if (previous != 0) {
+            // A stamp behind its predecessor (TSC skew) records as zero
+            hops_[stage].record(stamp > previous ? stamp - previous : 0);
+        } else {
+            first = stamp;
+        }
+        previous = stamp;
+    }
+    if (first != 0 && previous > first) {
+        end_to_end_.record(previous - first);
+    }
+}
+
+// ============================================================================
+// Reporting
+// ============================================================================
+void Tracer::flush() const {
+    while (aggregated() < submitted_.load(std::memory_order_relaxed)) {
+        std::this_thread::yield();
+    }
+}
+
+LatencyHistogram Tracer::hop(TraceStage to) const {
+    std::lock_guard<std::mutex> lock(histogram_mutex_);
+    return hops_[static_cast<size_t>(to)];
+}
+
+LatencyHistogram Tracer::end_to_end() const {
+    std::lock_guard<std::mutex> lock(histogram_mutex_);
+    return end_to_end_;
+}
+
+void Tracer::print() const {
+    std::lock_guard<std::mutex> lock(histogram_mutex_);
+    double scale = tsc::ns_per_tick();
+    std::printf("Pipeline trace: %lu records aggregated, %lu dropped\n",
+                static_cast<unsigned long>(aggregated()), static_cast<unsigned long>(dropped()));
+    for (size_t stage = 1; stage < kTraceStageCount; ++stage) {
+        if (hops_[stage].count() == 0) continue;
+        // Hops are keyed by their later stage; name the hop after the
+        // nearest earlier stage that was stamped
+        size_t from = stage - 1;
+        while (from > 0 && hops_[from].count() == 0) from--;
+        char label[48];
+        std::snprintf(label, sizeof(label), "%s->%s",
+                      trace_stage_name(static_cast<TraceStage>(from)),
+                      trace_stage_name(static_cast<TraceStage>(stage)));
+        hops_[stage].print(label, scale);
+    }
+    end_to_end_.print("end to end", scale);
+}
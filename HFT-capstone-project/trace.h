@@ -0,0 +1,91 @@
+#pragma once
+
+#include "latency_stats.h"
+#include "spsc_q3.h"
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+// ============================================================================
+// Pipeline Trace Record (64 bytes, travels with the message)
+// ============================================================================
+// Each pipeline stage writes the TSC into its slot as the message passes.
+// Stamps from different threads are comparable because the TSC is invariant
+// and synchronized across cores on the CPUs we run on (constant_tsc,
+// nonstop_tsc). A zero stamp means the message skipped that stage.
+enum class TraceStage : uint8_t {
+    Receive = 0,   // Bytes off the socket / capture
+    Decode,        // Wire message decoded
+    Enqueue,       // Pushed onto the feed -> book queue
+    Dequeue,       // Popped by the book thread
+    BookApply,     // Book updated
+    Publish,       // Market data published
+    kCount
+};
+
+constexpr size_t kTraceStageCount = static_cast<size_t>(TraceStage::kCount);
+
+struct alignas(64) TraceRecord {
+    uint64_t id;                        // Message id (e.g. feed sequence)
+    uint64_t tsc[kTraceStageCount];
+
+    void stamp(TraceStage stage) { tsc[static_cast<size_t>(stage)] = tsc::start(); }
+};
+static_assert(sizeof(TraceRecord) == 64, "TraceRecord must stay one cache line");
+
+const char* trace_stage_name(TraceStage stage);
+
+// ============================================================================
+// Tracer (background aggregation)
+// ============================================================================
+// The last stage hands a finished record to submit(); a background thread
+// drains them through a Fifo3 ring and keeps a latency histogram for every
+// stage-to-stage hop (from the previous stamped stage) and for end to end.
+// submit() never blocks: when the ring is full the record is dropped and
+// counted. submit() must always be called from the same thread.
+class Tracer {
+private:
+    Fifo3<TraceRecord> queue_;
+    std::thread aggregator_;
+    std::atomic<bool> running_;
+    std::atomic<uint64_t> submitted_;
+    std::atomic<uint64_t> aggregated_;
+    std::atomic<uint64_t> dropped_;
+
+    mutable std::mutex histogram_mutex_;
+    LatencyHistogram hops_[kTraceStageCount];  // Indexed by the later stage
+    LatencyHistogram end_to_end_;
+
+    void aggregator_loop();
+    void aggregate(const TraceRecord& record);
+
+public:
+    explicit Tracer(size_t queue_capacity = 1 << 14);
+    ~Tracer();
+
+    Tracer(const Tracer&) = delete;
+    Tracer& operator=(const Tracer&) = delete;
+
+    // Hand off a completed record; false if it was dropped
+    bool submit(const TraceRecord& record) {
+        if (!queue_.push(record)) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        submitted_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Wait until every submitted record has been aggregated
+    void flush() const;
+
+    // Print per-hop and end-to-end percentiles in ns
+    void print() const;
+
+    // Copy of one hop's histogram (ticks), e.g. for merging across pipelines
+    LatencyHistogram hop(TraceStage to) const;
+    LatencyHistogram end_to_end() const;
+
+    uint64_t aggregated() const { return aggregated_.load(std::memory_order_acquire); }
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+};
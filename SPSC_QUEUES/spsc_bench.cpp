@@ -0,0 +1,307 @@
+#include "spsc_q1.cpp"
+#include "spsc_q2.cpp"
+#include "spsc_q3.h"
+#include "spsc_q4.cpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include <pthread.h>
+#include <sched.h>
+
+// SPSC queue comparison. For every queue, element size (8/64/256 bytes) and
+// capacity (1K/32K/1M) it measures
+//   - throughput: producer and consumer on their own pinned cores, the
+//     consumer checking that sequence numbers arrive in order
+//   - round trip: ping-pong through a pair of queues, one element in flight
+// and prints a single table. Fifo1 is not threadsafe, so it runs on one
+// thread (push a batch, pop a batch) as the no-synchronization baseline.
+// Fifo2 differs from Fifo3 in its seq_cst cursor updates and unpadded
+// cursors; Fifo4 adds cached cursors to Fifo3.
+//
+//   spsc_bench [--check] [messages] [round_trips] [producer_cpu] [consumer_cpu]
+//
+// --check runs a short ordering check of the threadsafe queues only; build
+// with -DSPSC_ENABLE_TSAN=ON to run it (or the full table) under
+// ThreadSanitizer.
+
+namespace {
+
+template<size_t Size>
+struct Payload {
+    uint64_t seq;
+    uint8_t pad[Size - sizeof(uint64_t)];
+};
+
+// No zero-length pad for the 8-byte element
+template<>
+struct Payload<8> {
+    uint64_t seq;
+};
+
+static_assert(sizeof(Payload<8>) == 8);
+static_assert(sizeof(Payload<64>) == 64);
+static_assert(sizeof(Payload<256>) == 256);
+
+struct Config {
+    size_t messages = 4000000;
+    size_t round_trips = 100000;
+    int producer_cpu = 0;
+    int consumer_cpu = 1;
+    unsigned spin_limit = 4096;  // Busy polls before yielding the core
+};
+
+struct Result {
+    double mmsgs_per_sec = 0.0;
+    uint64_t rtt_p50_ns = 0;
+    uint64_t rtt_p99_ns = 0;
+    bool ok = true;
+};
+
+uint64_t now_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+bool pin_to_cpu(int cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+// Spin, then yield: on a machine with fewer cores than threads the other
+// side can only make progress once we give up the core
+class Backoff {
+private:
+    unsigned limit_;
+    unsigned spins_ = 0;
+
+public:
+    explicit Backoff(unsigned limit) : limit_(limit) {}
+
+    void wait() {
+        if (++spins_ < limit_) {
+            cpu_relax();
+        } else {
+            spins_ = 0;
+            std::this_thread::yield();
+        }
+    }
+    void reset() { spins_ = 0; }
+};
+
+uint64_t percentile(std::vector<uint64_t>& samples, double pct) {
+    if (samples.empty()) return 0;
+    std::sort(samples.begin(), samples.end());
+    size_t idx = static_cast<size_t>(pct / 100.0 * static_cast<double>(samples.size() - 1));
+    return samples[idx];
+}
+
+// ============================================================================
+// Two-thread throughput
+// ============================================================================
+template<typename Queue, typename Element>
+Result run_throughput(size_t capacity, const Config& config) {
+    Queue queue(capacity);
+    Result result;
+    bool in_order = true;
+
+    std::thread consumer([&] {
+        pin_to_cpu(config.consumer_cpu);
+        Backoff backoff(config.spin_limit);
+        Element value{};
+        for (uint64_t expected = 0; expected < config.messages; ++expected) {
+            while (!queue.pop(value)) backoff.wait();
+            backoff.reset();
+            if (value.seq != expected) in_order = false;
+        }
+    });
+
+    pin_to_cpu(config.producer_cpu);
+    Backoff backoff(config.spin_limit);
+    Element value{};
+    uint64_t start = now_ns();
+    for (uint64_t seq = 0; seq < config.messages; ++seq) {
+        value.seq = seq;
+        while (!queue.push(value)) backoff.wait();
+        backoff.reset();
+    }
+    consumer.join();
+    uint64_t elapsed = now_ns() - start;
+
+    result.mmsgs_per_sec = static_cast<double>(config.messages) * 1e3 / static_cast<double>(elapsed);
+    result.ok = in_order;
+    return result;
+}
+
+// ============================================================================
+// Ping-pong round trip (one element in flight)
+// ============================================================================
+template<typename Queue, typename Element>
+void run_round_trip(size_t capacity, const Config& config, Result& result) {
+    Queue ping(capacity);
+    Queue pong(capacity);
+    bool echoed_in_order = true;
+
+    std::thread echo([&] {
+        pin_to_cpu(config.consumer_cpu);
+        Backoff backoff(config.spin_limit);
+        Element value{};
+        for (uint64_t expected = 0; expected < config.round_trips; ++expected) {
+            while (!ping.pop(value)) backoff.wait();
+            backoff.reset();
+            if (value.seq != expected) echoed_in_order = false;
+            while (!pong.push(value)) backoff.wait();
+            backoff.reset();
+        }
+    });
+
+    pin_to_cpu(config.producer_cpu);
+    Backoff backoff(config.spin_limit);
+    std::vector<uint64_t> samples;
+    samples.reserve(config.round_trips);
+    Element value{};
+    for (uint64_t seq = 0; seq < config.round_trips; ++seq) {
+        value.seq = seq;
+        uint64_t t0 = now_ns();
+        while (!ping.push(value)) backoff.wait();
+        backoff.reset();
+        while (!pong.pop(value)) backoff.wait();
+        backoff.reset();
+        samples.push_back(now_ns() - t0);
+        if (value.seq != seq) echoed_in_order = false;
+    }
+    echo.join();
+
+    result.rtt_p50_ns = percentile(samples, 50.0);
+    result.rtt_p99_ns = percentile(samples, 99.0);
+    result.ok = result.ok && echoed_in_order;
+}
+
+// ============================================================================
+// Single-thread baseline for the non-threadsafe Fifo1
+// ============================================================================
+template<typename Element>
+Result run_single_thread(size_t capacity, const Config& config) {
+    Fifo1<Element> queue(capacity);
+    Result result;
+    const size_t batch = std::max<size_t>(capacity / 2, 1);
+    Element value{};
+    uint64_t next_push = 0;
+    uint64_t expected = 0;
+
+    uint64_t start = now_ns();
+    while (expected < config.messages) {
+        for (size_t i = 0; i < batch && next_push < config.messages; ++i) {
+            value.seq = next_push++;
+            queue.push(value);
+        }
+        while (queue.pop(value)) {
+            if (value.seq != expected++) result.ok = false;
+        }
+    }
+    uint64_t elapsed = now_ns() - start;
+    result.mmsgs_per_sec = static_cast<double>(config.messages) * 1e3 / static_cast<double>(elapsed);
+    return result;
+}
+
+void print_row(const char* queue, size_t element_size, size_t capacity, const char* threads,
+               const Result& r, bool has_rtt) {
+    double mb_per_sec = r.mmsgs_per_sec * static_cast<double>(element_size);
+    if (has_rtt) {
+        std::printf("%-6s | %4zu | %8zu | %7s | %8.2f | %8.0f | %7lu | %7lu | %s\n",
+                    queue, element_size, capacity, threads, r.mmsgs_per_sec, mb_per_sec,
+                    static_cast<unsigned long>(r.rtt_p50_ns),
+                    static_cast<unsigned long>(r.rtt_p99_ns), r.ok ? "ok" : "FAIL");
+    } else {
+        std::printf("%-6s | %4zu | %8zu | %7s | %8.2f | %8.0f | %7s | %7s | %s\n",
+                    queue, element_size, capacity, threads, r.mmsgs_per_sec, mb_per_sec,
+                    "-", "-", r.ok ? "ok" : "FAIL");
+    }
+    std::fflush(stdout);
+}
+
+template<typename Element>
+bool run_element(size_t capacity, const Config& config, bool check_only) {
+    const size_t size = sizeof(Element);
+    bool ok = true;
+
+    if (!check_only) {
+        Result r1 = run_single_thread<Element>(capacity, config);
+        print_row("Fifo1", size, capacity, "1", r1, false);
+        ok = ok && r1.ok;
+    }
+
+    Result r2 = run_throughput<Fifo2<Element>, Element>(capacity, config);
+    run_round_trip<Fifo2<Element>, Element>(capacity, config, r2);
+    print_row("Fifo2", size, capacity, "2", r2, true);
+
+    Result r3 = run_throughput<Fifo3<Element>, Element>(capacity, config);
+    run_round_trip<Fifo3<Element>, Element>(capacity, config, r3);
+    print_row("Fifo3", size, capacity, "2", r3, true);
+
+    Result r4 = run_throughput<Fifo4<Element>, Element>(capacity, config);
+    run_round_trip<Fifo4<Element>, Element>(capacity, config, r4);
+    print_row("Fifo4", size, capacity, "2", r4, true);
+
+    return ok && r2.ok && r3.ok && r4.ok;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    Config config;
+    bool check_only = false;
+    int arg = 1;
+    if (arg < argc && std::strcmp(argv[arg], "--check") == 0) {
+        check_only = true;
+        config.messages = 200000;
+        config.round_trips = 10000;
+        arg++;
+    }
+    if (arg < argc) config.messages = static_cast<size_t>(std::strtoull(argv[arg++], nullptr, 10));
+    if (arg < argc) config.round_trips = static_cast<size_t>(std::strtoull(argv[arg++], nullptr, 10));
+    if (arg < argc) config.producer_cpu = std::atoi(argv[arg++]);
+    if (arg < argc) config.consumer_cpu = std::atoi(argv[arg++]);
+
+    unsigned cpus = std::max(1u, std::thread::hardware_concurrency());
+    config.producer_cpu %= static_cast<int>(cpus);
+    config.consumer_cpu %= static_cast<int>(cpus);
+    if (config.producer_cpu == config.consumer_cpu) {
+        // Sharing a core: spinning only burns the other side's time slice
+        config.spin_limit = 1;
+        std::printf("Note: producer and consumer share CPU %d (%u CPU%s available); "
+                    "numbers reflect scheduling, not cache-line transfer.\n",
+                    config.producer_cpu, cpus, cpus == 1 ? "" : "s");
+    }
+    std::printf("%zu messages per throughput run, %zu round trips, producer CPU %d, consumer CPU %d\n\n",
+                config.messages, config.round_trips, config.producer_cpu, config.consumer_cpu);
+
+    const std::vector<size_t> capacities = check_only ? std::vector<size_t>{16, 1024}
+                                                      : std::vector<size_t>{1024, 32768, 1048576};
+
+    std::printf("queue  | elem | capacity | threads |  M msg/s |     MB/s | RTT p50 | RTT p99 | order\n");
+    std::printf("-------+------+----------+---------+----------+----------+---------+---------+------\n");
+    bool ok = true;
+    for (size_t capacity : capacities) {
+        ok = run_element<Payload<8>>(capacity, config, check_only) && ok;
+        ok = run_element<Payload<64>>(capacity, config, check_only) && ok;
+        ok = run_element<Payload<256>>(capacity, config, check_only) && ok;
+    }
+    std::printf("\nRTT in ns (ping-pong, one element in flight). %s\n",
+                ok ? "All queues delivered every message in order." : "ORDERING FAILURES ABOVE.");
+    return ok ? 0 : 1;
+}
@@ -103,10 +103,10 @@ private:
     static constexpr auto hardware_destructive_interference_size = size_type{64};
 
     /// Loaded and stored by the push thread; loaded by the pop thread
-    alignas(hardware_destructive_interference_size) CursorType pushCursor_;
+    alignas(hardware_destructive_interference_size) CursorType pushCursor_{};
 
     /// Loaded and stored by the pop thread; loaded by the push thread
-    alignas(hardware_destructive_interference_size) CursorType popCursor_;
+    alignas(hardware_destructive_interference_size) CursorType popCursor_{};
 
     // Padding to avoid false sharing with adjacent objects
     char padding_[hardware_destructive_interference_size - sizeof(size_type)];